@@ -80,6 +80,13 @@ void calibration_button_pressed(uint8_t button);
 uint16_t calibration_get_min(uint8_t pot);
 uint16_t calibration_get_max(uint8_t pot);
 void calibration_write_default(void);
+uint8_t calibration_get_min_cutoff(uint8_t pot);
+uint8_t calibration_get_beta(uint8_t pot);
+//stores the adaptive filter tuning of a pot, it is applied when the actuators are created
+void calibration_write_filter(uint8_t pot, uint8_t min_cutoff, uint8_t beta);
+void calibration_write_filter_default(void);
+//stores the adaptive filter tuning of a pot and applies it right away
+uint8_t calibration_set_filter(uint8_t pot, uint8_t min_cutoff, uint8_t beta);
 uint8_t calibration_check_valid(void);
 uint8_t calibration_check_valid_pot(uint8_t pot);
 void calibration_write_max(uint8_t pot);
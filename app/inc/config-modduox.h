@@ -14,6 +14,7 @@
 #define SET_PIN(port, pin)              GPIO_SetValue((port), (1 << (pin)))
 #define CLR_PIN(port, pin)              GPIO_ClearValue((port), (1 << (pin)))
 #define READ_PIN(port, pin)             ((FIO_ReadValue(port) >> (pin)) & 1)
+#define READ_PINS(port)                 FIO_ReadValue(port)
 #define CONFIG_PORT_INPUT(port)         FIO_ByteSetDir((port), 0, 0xFF, GPIO_DIRECTION_INPUT)
 #define CONFIG_PORT_OUTPUT(port)        FIO_ByteSetDir((port), 0, 0xFF, GPIO_DIRECTION_OUTPUT)
 #define WRITE_PORT(port, value)         FIO_ByteSetValue((port), 0, (uint8_t)(value)); \
@@ -31,11 +32,13 @@
 #define SERIAL3_RX_PORT         0
 #define SERIAL3_RX_PIN          3
 #define SERIAL3_RX_FUNC         2
-#define SERIAL3_RX_BUFF_SIZE    32
+#define SERIAL3_RX_BUFF_SIZE    WEBGUI_COMM_RX_BUFF_SIZE
 #define SERIAL3_TX_PORT         0
 #define SERIAL3_TX_PIN          2
 #define SERIAL3_TX_FUNC         2
-#define SERIAL3_TX_BUFF_SIZE    32
+#define SERIAL3_TX_BUFF_SIZE    256
+#define SERIAL3_TX_DMA_CHANNEL  2
+#define SERIAL3_RX_DMA_CHANNEL  0
 #define SERIAL3_HAS_OE          0
 
 // SERIAL2 CLI
@@ -59,11 +62,13 @@
 #define SERIAL0_RX_PORT         0
 #define SERIAL0_RX_PIN          1
 #define SERIAL0_RX_FUNC         4
-#define SERIAL0_RX_BUFF_SIZE    32
+#define SERIAL0_RX_BUFF_SIZE    SYSTEM_COMM_RX_BUFF_SIZE
 #define SERIAL0_TX_PORT         0
 #define SERIAL0_TX_PIN          0
 #define SERIAL0_TX_FUNC         4
-#define SERIAL0_TX_BUFF_SIZE    32
+#define SERIAL0_TX_BUFF_SIZE    256
+#define SERIAL0_TX_DMA_CHANNEL  3
+#define SERIAL0_RX_DMA_CHANNEL  1
 #define SERIAL0_HAS_OE          0
 
 //// Hardware peripheral definitions
@@ -152,6 +157,8 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 
 //for encoder acceleration
 //acceleration devided in x steps within 100 times the actuator clock. 
+//the steps are turned into the time between detents, so each encoder accelerates on its own
+#define ENCODER_ACCEL_WINDOW            100
 #define ENCODER_ACCEL_STEP_1            3
 #define ENCODER_ACCEL_STEP_2            5
 #define ENCODER_ACCEL_STEP_3            7
@@ -162,6 +169,16 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 //the resolution of a pot
 #define POT_THRESHOLD       4
 
+//adaptive smoothing of the pot values (1 euro filter), the cutoff rises from the min cutoff with
+//the speed of the pot, the speed is the pot derivative smoothed by 1/2^shift (1/64)
+#define POT_SPEED_SHIFT     6
+
+//oversampling of the pots, the DMA interrupt sums the last 2^shift conversions (16) of every pot
+#define POT_OVERSAMPLING_SHIFT  4
+
+//DMA channel that moves the pot conversions from the ADC to memory
+#define POTS_DMA_CHANNEL        4
+
 #define POT_LOWER_THRESHOLD (POT_THRESHOLD)
 #define POT_UPPER_THRESHOLD (4095- POT_THRESHOLD)
 
@@ -210,6 +227,10 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 // navigation update time, this is only useful in tool mode
 #define NAVEG_UPDATE_TIME   1500
 
+// time in milliseconds between flushes of the pending encoders and pots values
+// the values are also flushed as soon as there are no more actuators events and the link is idle
+#define CONTROL_FLUSH_TIME  5
+
 // time in milliseconds to enter in tool mode (hold rotary encoder button)
 #define TOOL_MODE_TIME      500
 
@@ -580,6 +601,8 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 #define DISPLAY_CONTRAST_LEFT_ADRESS       36
 #define LED_BRIGHTNESS_ADRESS              37
 #define DISPLAY_CONTRAST_RIGHT_ADRESS      38
+//2 bytes per pot, the min cutoff and the beta of its filter
+#define POT_FILTER_ADRESS_START            40
 
 //default settings
 #define DEFAULT_HIDE_ACTUATOR              0
@@ -587,6 +610,9 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 #define DEFAULT_DISPLAY_BRIGHTNESS         4
 #define DEFAULT_PAGE_MODE                  0
 #define DEFAULT_LED_BRIGHTNESS             2
+//min cutoff in 0.1Hz steps, beta in 0.001Hz per value/s steps
+#define DEFAULT_POT_MIN_CUTOFF             5
+#define DEFAULT_POT_BETA                   3
 
 //memory used for LED value's 
 #define LED_COLOR_EEMPROM_PAGE             2
@@ -596,7 +622,7 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 #define EEPROM_VERSION_ADRESS              62
 
 //for version control, when increasing they ALWAYS need to be bigger then the previous value
-#define EEPROM_CURRENT_VERSION             1211L
+#define EEPROM_CURRENT_VERSION             1212L
 
 //for testing purposes, overwrites the EEPROM regardless of the version
 #define FORCE_WRITE_EEPROM                0
@@ -634,6 +660,35 @@ enum {ENCODER0, ENCODER1, FOOTSWITCH0, FOOTSWITCH1, FOOTSWITCH2, FOOTSWITCH3, FO
 #define SERIAL3_RX_BUFF_SIZE    0
 #endif
 
+// check serial tx DMA channel, the serials without it transmit from the THRE interrupt
+#ifndef SERIAL0_TX_DMA_CHANNEL
+#define SERIAL0_TX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL1_TX_DMA_CHANNEL
+#define SERIAL1_TX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL2_TX_DMA_CHANNEL
+#define SERIAL2_TX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL3_TX_DMA_CHANNEL
+#define SERIAL3_TX_DMA_CHANNEL  -1
+#endif
+
+// check serial rx DMA channel, the serials without it read the FIFO in the uart interrupt
+// the rx buffer size of the serials with it must be a power of two
+#ifndef SERIAL0_RX_DMA_CHANNEL
+#define SERIAL0_RX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL1_RX_DMA_CHANNEL
+#define SERIAL1_RX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL2_RX_DMA_CHANNEL
+#define SERIAL2_RX_DMA_CHANNEL  -1
+#endif
+#ifndef SERIAL3_RX_DMA_CHANNEL
+#define SERIAL3_RX_DMA_CHANNEL  -1
+#endif
+
 // check serial tx buffer size
 #ifndef SERIAL0_TX_BUFF_SIZE
 #define SERIAL0_TX_BUFF_SIZE    0
@@ -36,6 +36,8 @@ typedef enum {TEXT_SINGLE_LINE, TEXT_MULTI_LINES} text_mode_t;
 
 typedef enum {GRAPH_TYPE_LINEAR, GRAPH_TYPE_LOG, GRAPH_TYPE_V, GRAPH_TYPE_A} graph_type_t;
 
+#define KNOB_INVALID_POSITION   0xFF
+
 typedef enum {OK_ONLY, OK_CANCEL, CANCEL_ONLY, YES_NO, EMPTY_POPUP} popup_type_t;
 
 
@@ -146,6 +148,8 @@ void widget_toggle_encoder(glcd_t *display, toggle_t *toggle);
 void widget_toggle(glcd_t *display, toggle_t *toggle); 
 void widget_tuner(glcd_t *display, tuner_t *tuner);
 void widget_popup(glcd_t *display, popup_t *popup);
+// returns the knob indicator position drawn by widget_knob, KNOB_INVALID_POSITION if the mode is unknown
+uint8_t widget_knob_position(knob_t *knob);
 void widget_knob(glcd_t *display, knob_t *knob);
 void widget_bar_indicator(glcd_t *display, bar_t *bar); 
 
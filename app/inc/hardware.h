@@ -40,6 +40,9 @@ enum {COREBOARD_INIT, COREBOARD_TURN_OFF, COREBOARD_TURN_ON};
 
 #define MAX_BRIGHTNESS      4
 
+// flag of the pots sums, set once the sum holds all the conversions of the channel
+#define HARDWARE_POT_SUM_VALID  (1UL << 31)
+
 //// Foot functions leds colors
 #define RED                 LEDZ_RED
 #define GREEN               LEDZ_GREEN
@@ -92,6 +95,9 @@ void *hardware_actuators(uint8_t actuator_id);
 uint32_t hardware_timestamp(void);
 //get encoder acceleration
 uint8_t hardware_get_acceleration(void);
+//returns the sums of the last 2^POT_OVERSAMPLING_SHIFT conversions of each ADC channel, HARDWARE_POT_SUM_VALID
+//is set once a channel has all of them
+const volatile uint32_t *hardware_pots_sums(void);
 //get current ADC value of potentiometer
 uint16_t hardware_get_pot_value(uint8_t pot);
 //change a LED color definition in eeprom
@@ -82,10 +82,10 @@ void naveg_ui_connection(uint8_t status);
 void naveg_add_control(control_t *control, uint8_t protocol);
 // removes the control from controls list
 void naveg_remove_control(uint8_t hw_id);
-// increment the control value
-void naveg_inc_control(uint8_t display);
-// decrement the control value
-void naveg_dec_control(uint8_t display);
+// increment the control value by the given amount of steps
+void naveg_inc_control(uint8_t display, uint8_t steps);
+// decrement the control value by the given amount of steps
+void naveg_dec_control(uint8_t display, uint8_t steps);
 // sets the control value
 void naveg_set_control(uint8_t hw_id, float value);
 // gets the control value
@@ -94,6 +94,12 @@ control_t* naveg_get_control(uint8_t hw_id);
 // change the foot value
 void naveg_foot_change(uint8_t foot, uint8_t pressed);
 void naveg_pot_change(uint8_t pot);
+// returns non zero if there are encoders or pots values waiting to be sent
+uint32_t naveg_pending_control_values(void);
+// sends the pending values, if force is zero only when CONTROL_FLUSH_TIME has elapsed since the last flush
+void naveg_flush_control_values(uint8_t force);
+// gets the amount of control_set messages sent and of values replaced by a newer one before being sent
+void naveg_control_values_stats(uint32_t *sent, uint32_t *coalesced);
 // toggle between control and tool
 void naveg_toggle_tool(uint8_t tool, uint8_t display);
 //save snapshots
@@ -120,10 +126,10 @@ void naveg_set_pedalboards(bp_list_t *bp_list);
 bp_list_t *naveg_get_pedalboards(void);
 // runs the enter action on tool mode
 void naveg_enter(uint8_t display);
-// runs the up action on tool mode
-void naveg_up(uint8_t display);
-// runs the down action on tool mode
-void naveg_down(uint8_t display);
+// runs the up action on tool mode the given amount of steps
+void naveg_up(uint8_t display, uint8_t steps);
+// runs the down action on tool mode the given amount of steps
+void naveg_down(uint8_t display, uint8_t steps);
 // resets to root menu
 void naveg_reset_menu(void);
 // update the navigation screen if necessary
@@ -135,6 +141,10 @@ void naveg_set_pb_list_update(void);
 bool naveg_get_pb_list_update(void);
 void naveg_update_pb_list(void);
 
+// this function will be called when the pedalboards list must be reloaded by the displays task
+// the user must create this function in your application code
+extern void naveg_pb_list_request(void);
+
 uint8_t naveg_dialog(const char *msg, char *title);
 uint8_t naveg_ui_status(void);
 void naveg_pages_available(uint8_t page_1, uint8_t page_2, uint8_t page_3, uint8_t page_4, uint8_t page_5, uint8_t page_6);
@@ -32,6 +32,41 @@
 ************************************************************************************************************************
 */
 
+// maximum amount of tokens (command included) of a message, a message is at most as long as the rx
+// buffer of its serial and each token but the first takes at least its separator
+#define PROTOCOL_MAX_ARGUMENTS          ((WEBGUI_COMM_RX_BUFF_SIZE > SYSTEM_COMM_RX_BUFF_SIZE) ? \
+                                         WEBGUI_COMM_RX_BUFF_SIZE : SYSTEM_COMM_RX_BUFF_SIZE)
+
+// tokens held by the static list of each protocol task in 256 bytes, it takes every fixed size command,
+// the control_add with up to 25 scale points (13 fixed tokens plus a label/value pair per point) and the
+// banks and pedalboards pages of up to 29 items (5 fixed tokens plus a name/uid pair per item), the
+// longer messages list their tokens on the heap
+#define PROTOCOL_STATIC_ARGUMENTS       64
+
+// pipelined requests extension: mod-ui negotiates the window size (0 disables it), after that
+// the control_set messages carry a sequence tag as last argument and are answered with a tagged response
+#ifndef CMD_PIPELINE
+#define CMD_PIPELINE                    "pipeline %i"
+#endif
+#ifndef CMD_TAGGED_RESPONSE
+#define CMD_TAGGED_RESPONSE             "rt %i %i ..."
+#endif
+
+// control values statistics: answers with the amount of values sent to mod-ui and of the ones
+// coalesced with a newer value before being sent
+#ifndef CMD_CONTROL_STATS
+#define CMD_CONTROL_STATS               "control_stats"
+#endif
+
+// adaptive pot filter tuning: sets the min cutoff and the beta of a pot, they are stored in the eeprom
+// and used right away, the get command answers with both
+#ifndef CMD_POT_FILTER_SET
+#define CMD_POT_FILTER_SET              "pot_filter_set %i %i %i"
+#endif
+#ifndef CMD_POT_FILTER_GET
+#define CMD_POT_FILTER_GET              "pot_filter_get %i"
+#endif
+
 // defines the function to send responses to sender
 #define SEND_TO_SENDER(id,msg,len)      (id == SYSTEM_SERIAL) ? sys_comm_send(msg,NULL) : ui_comm_webgui_send(msg,len)
 
@@ -102,6 +137,11 @@ void cb_initial_state(uint8_t serial_id, proto_t *proto);
 void cb_bank_config(uint8_t serial_id, proto_t *proto);
 void cb_tuner(uint8_t serial_id, proto_t *proto);
 void cb_resp(uint8_t serial_id, proto_t *proto);
+void cb_tagged_resp(uint8_t serial_id, proto_t *proto);
+void cb_pipeline(uint8_t serial_id, proto_t *proto);
+void cb_control_stats(uint8_t serial_id, proto_t *proto);
+void cb_pot_filter_set(uint8_t serial_id, proto_t *proto);
+void cb_pot_filter_get(uint8_t serial_id, proto_t *proto);
 void cb_restore(uint8_t serial_id, proto_t *proto);
 void cb_boot(uint8_t serial_id, proto_t *proto);
 void cb_menu_item_changed(uint8_t serial_id, proto_t *proto);
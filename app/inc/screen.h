@@ -61,8 +61,18 @@
 ************************************************************************************************************************
 */
 
+void screen_init(void);
+// the drawing lock is held by a task while it draws a whole screen, it serializes the drawing into the
+// displays buffers and the widgets caches, it is recursive
+void screen_lock(void);
+void screen_unlock(void);
+// the waits on another task which draws release the lock of the caller and restore it afterwards
+uint8_t screen_lock_release(void);
+void screen_lock_restore(uint8_t depth);
 void screen_set_hide_non_assigned_actuators(uint8_t hide);
 void screen_clear(uint8_t display_id);
+// forgets what the pots, encoder and footers of the display show, so they are fully drawn next time
+void screen_invalidate(uint8_t display_id);
 void screen_encoder(uint8_t display_id, control_t *control);
 void screen_footer(uint8_t id, const char *name, const char *value, int16_t property);
 void screen_pot(uint8_t pot_id, control_t *control);
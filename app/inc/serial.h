@@ -45,6 +45,13 @@
 // output enable pin level
 #define OUTPUT_ENABLE_ACTIVE_IN_HIGH
 
+// timeout value used to wait until all data is queued to be sent
+#define SERIAL_WAIT_FOREVER     0xFFFFFFFF
+
+// GPDMA interrupt priority, used by the serials which transmit through DMA
+// the interrupt uses freeRTOS API, so it must be equal or greater than configMAX_SYSCALL_INTERRUPT_PRIORITY
+#define SERIAL_DMA_PRIORITY     5
+
 
 /*
 ************************************************************************************************************************
@@ -63,6 +70,12 @@ typedef struct SERIAL_T {
     ringbuff_t *rx_buffer;
     ringbuff_t *tx_buffer;
     void (*rx_callback)(struct SERIAL_T *serial);
+    // GPDMA channel used to transmit, negative to transmit from the THRE interrupt
+    int8_t tx_dma_channel;
+    // GPDMA channel used to receive, negative to read the FIFO in the uart interrupt
+    int8_t rx_dma_channel;
+    uint32_t tx_dma_size;
+    void (*transmit)(struct SERIAL_T *serial);
 
     // output enable
     uint8_t has_oe;
@@ -93,11 +106,32 @@ typedef struct SERIAL_T {
 void serial_init(serial_t *serial);
 void serial_enable_interupt(serial_t *serial);
 void serial_change_interupt_priority(serial_t *serial);
+// serial_send: blocks the calling task until all data is queued to be sent
 uint32_t serial_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size);
+// serial_send_timeout: same as serial_send but gives up after timeout (in milliseconds), returns the bytes queued
+uint32_t serial_send_timeout(uint8_t uart_id, const uint8_t *data, uint32_t data_size, uint32_t timeout);
+// serial_try_send: queues only what fits on the tx buffer without blocking, returns the bytes queued
+uint32_t serial_try_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size);
 uint32_t serial_read(uint8_t uart_id, uint8_t *data, uint32_t data_size);
 uint32_t serial_read_until(uint8_t uart_id, uint8_t *data, uint32_t data_size, uint8_t token);
 void serial_set_callback(uint8_t uart_id, void (*receive_cb)(serial_t *serial));
 void serial_flush_tx_buffer(uint8_t uart_id);
+// serial_set_frames: enables the frame mode, the received bytes are split by token and kept on the rx buffer
+//                    until released, max_frames is how many complete frames can wait to be read
+//                    returns zero if the frames buffers couldn't be allocated
+uint8_t serial_set_frames(uint8_t uart_id, uint8_t token, uint32_t max_frames);
+// serial_read_frame: blocks until a complete frame is received, points frame to it (token included) and
+//                    returns its size, the frame must be released after being used, it is only pointed
+//                    in place on the rx buffer when the reception isn't done by DMA and it doesn't wrap
+uint32_t serial_read_frame(uint8_t uart_id, uint8_t **frame);
+// serial_release_frame: frees the space of the frame on the rx buffer, if it was read in place
+void serial_release_frame(uint8_t uart_id, uint32_t size);
+// serial_flush_frames: drops all the received data and frames
+void serial_flush_frames(uint8_t uart_id);
+// serial_rx_dma_poll: must be called periodically (e.g. each 1ms) to publish the bytes received through DMA
+void serial_rx_dma_poll(void);
+// serial_dma_handler: must be called from the DMA interrupt, it services the tx DMA channels of the serials
+void serial_dma_handler(void);
 
 // this function will be called automatically from UART interrupt in case of error
 // the user must create this function in your application code
@@ -66,8 +66,10 @@ void sys_comm_init(void);
 //// webgui communication functions
 // sends a message to webgui
 void sys_comm_send(const char *command, const char *arguments);
-// read a message from webgui
-ringbuff_t* sys_comm_read(void);
+// blocks until a complete message is received, points data to it and returns its size
+uint32_t sys_comm_read(char **data);
+// releases the space of the message after it was parsed
+void sys_comm_release(uint32_t data_size);
 // sets a function callback to webgui response
 void sys_comm_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item);
 // invokes the response function callback
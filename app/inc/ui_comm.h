@@ -32,6 +32,11 @@
 ************************************************************************************************************************
 */
 
+// maximum amount of tagged requests waiting for a response when the pipelined mode is negotiated
+#define WEBGUI_PIPELINE_MAX_WINDOW  8
+// time (in milliseconds) to wait for a free slot before the requests in flight are given up
+#define WEBGUI_PIPELINE_TIMEOUT     500
+
 
 /*
 ************************************************************************************************************************
@@ -66,14 +71,28 @@ void ui_comm_init(void);
 //// webgui communication functions
 // sends a message to webgui
 void ui_comm_webgui_send(const char *data, uint32_t data_size);
-// read a message from webgui
-ringbuff_t* ui_comm_webgui_read(void);
+// blocks until a complete message is received, points data to it and returns its size
+uint32_t ui_comm_webgui_read(char **data);
+// releases the space of the message after it was parsed
+void ui_comm_webgui_release(uint32_t data_size);
 // sets a function callback to webgui response
 void ui_comm_webgui_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item);
 // invokes the response function callback
 void ui_comm_webgui_response_cb(void *data);
 // blocks the execution until the webgui response be received
 void ui_comm_webgui_wait_response(void);
+// sets the pipelined mode window (0 disables it), returns the accepted window
+uint8_t ui_comm_webgui_set_pipeline_window(uint8_t window);
+// returns non zero if the pipelined mode was negotiated
+uint8_t ui_comm_webgui_pipeline_enabled(void);
+// appends a sequence tag to the message and sends it, only blocks while the pipeline window is full
+// buffer_size is the size of data buffer, which needs to have room for the tag
+void ui_comm_webgui_send_tagged(char *data, uint32_t data_size, uint32_t buffer_size,
+                                void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item);
+// returns non zero if no request is waiting for a response
+uint8_t ui_comm_webgui_link_idle(void);
+// invokes the function callback of the tagged request
+void ui_comm_webgui_tagged_response_cb(uint8_t tag, void *data);
 // clear the data in the buffer
 void ui_comm_webgui_clear(void);
 void ui_comm_webgui_clear_tx_buffer(void);
@@ -32,7 +32,7 @@
 ************************************************************************************************************************
 */
 
-// uncomment the define below to enable the quotation marks evaluation on strarr_split parser
+// uncomment the define below to enable the quotation marks evaluation on strarr_split parsers
 #define ENABLE_QUOTATION_MARKS
 
 
@@ -73,6 +73,9 @@ typedef struct RINGBUFF_T {
 uint8_t copy_command(char *buffer, const char *command);
 // splits the string in each whitespace occurrence and returns a array of strings NULL terminated
 char** strarr_split(char *str, const char token);
+// same as strarr_split but fills the caller array (list_size includes the NULL terminator) instead
+// of allocating one, returns the tokens count which is bigger than list_size - 1 if the list overflowed
+uint32_t strarr_split_static(char *str, const char token, char **list, uint32_t list_size);
 // returns the string array length
 uint32_t strarr_length(char** const str_array);
 // joins a string array in a single string
@@ -100,7 +103,7 @@ float convert_to_ms(const char *unit_from, float value);
 float convert_from_ms(const char *unit_to, float value);
 
 // ring buffer functions
-// ringbuff_create: allocates memory to ring buffer
+// ringbuff_create: allocates memory to ring buffer, the size is rounded up to a power of two
 ringbuff_t *ringbuff_create(uint32_t buffer_size);
 // ringbuff_destroy: de-allocates memory of the ring buffer
 void ringbuff_destroy(ringbuff_t *rb);
@@ -108,6 +111,11 @@ void ringbuff_destroy(ringbuff_t *rb);
 uint32_t ringbuff_write(ringbuff_t *rb, const uint8_t *data, uint32_t data_size);
 // ringbuff_read: returns number of bytes read
 uint32_t ringbuff_read(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size);
+// ringbuff_peek_span: points data to the unread bytes and returns how many of them are contiguous,
+//                     they are kept in the ring buffer until a ringbuff_read with NULL buffer
+uint32_t ringbuff_peek_span(ringbuff_t *rb, uint8_t **data);
+// ringbuff_publish: moves the write index to head, used when the data was written by DMA
+void ringbuff_publish(ringbuff_t *rb, uint32_t head);
 // ringbuff_read_until: read ring buffer until find the token and returns number of bytes read
 uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size, uint8_t token);
 // ringbuffer_used_space: returns amount of unread bytes
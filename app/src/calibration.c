@@ -7,6 +7,7 @@
 
 #include "calibration.h"
 #include "hardware.h"
+#include "actuator.h"
 #include "glcd.h"
 #include "glcd_widget.h"
 #include "ledz.h"
@@ -147,8 +148,6 @@ void display_calibration_animation(uint8_t display)
     knob.max = 4095;
     knob.value = hardware_get_pot_value(current_pot);
     widget_knob(hardware_glcds(display), &knob);
-
-    glcd_update(hardware_glcds(display));
 }
 
 void display_calibration_text(uint8_t display)
@@ -193,8 +192,6 @@ void display_calibration_text(uint8_t display)
     explanation_text.y = 18;
     explanation_text.x = 1;
     widget_textbox(txt_display, &explanation_text);  
-
-    glcd_update(txt_display);
 }
 
 void display_error_message(uint8_t display, uint8_t error_message)
@@ -273,9 +270,6 @@ void display_error_message(uint8_t display, uint8_t error_message)
     explanation_text.y = 30;
     explanation_text.x = 1;
     widget_textbox(hardware_glcds(!display), &explanation_text);
-
-    glcd_update(hardware_glcds(display));
-    glcd_update(hardware_glcds(!display));
 }
 
 uint8_t check_range_sufficient(uint8_t pot)
@@ -634,6 +628,56 @@ void calibration_write_default(void)
     EEPROM_Write(0, POT_8_MAX_CALIBRATION_ADRESS, &write_buffer, MODE_16_BIT, 1);
 }
 
+uint8_t calibration_get_min_cutoff(uint8_t pot)
+{
+    uint8_t read_buffer = DEFAULT_POT_MIN_CUTOFF;
+
+    if (pot < POTS_COUNT)
+        EEPROM_Read(0, POT_FILTER_ADRESS_START + (pot * 2), &read_buffer, MODE_8_BIT, 1);
+
+    return read_buffer;
+}
+
+uint8_t calibration_get_beta(uint8_t pot)
+{
+    uint8_t read_buffer = DEFAULT_POT_BETA;
+
+    if (pot < POTS_COUNT)
+        EEPROM_Read(0, POT_FILTER_ADRESS_START + (pot * 2) + 1, &read_buffer, MODE_8_BIT, 1);
+
+    return read_buffer;
+}
+
+void calibration_write_filter(uint8_t pot, uint8_t min_cutoff, uint8_t beta)
+{
+    if (pot >= POTS_COUNT) return;
+
+    EEPROM_Write(0, POT_FILTER_ADRESS_START + (pot * 2), &min_cutoff, MODE_8_BIT, 1);
+    EEPROM_Write(0, POT_FILTER_ADRESS_START + (pot * 2) + 1, &beta, MODE_8_BIT, 1);
+}
+
+void calibration_write_filter_default(void)
+{
+    uint8_t i;
+    for (i = 0; i < POTS_COUNT; i++)
+    {
+        calibration_write_filter(i, DEFAULT_POT_MIN_CUTOFF, DEFAULT_POT_BETA);
+    }
+}
+
+uint8_t calibration_set_filter(uint8_t pot, uint8_t min_cutoff, uint8_t beta)
+{
+    if (pot >= POTS_COUNT) return 0;
+
+    calibration_write_filter(pot, min_cutoff, beta);
+
+    //the new tuning is used right away
+    actuator_set_prop(hardware_actuators(POT0 + pot), POT_MIN_CUTOFF, min_cutoff);
+    actuator_set_prop(hardware_actuators(POT0 + pot), POT_BETA, beta);
+
+    return 1;
+}
+
 //function to check if all value's are valid
 uint8_t calibration_check_valid(void)
 {
@@ -211,8 +211,9 @@ static void serial_cb(serial_t *serial)
 
 static void write_msg(const char *msg)
 {
-    glcd_clear(hardware_glcds(1), GLCD_WHITE);
-    glcd_clear(hardware_glcds(0), GLCD_WHITE);
+    screen_lock();
+    screen_clear(1);
+    screen_clear(0);
     textbox_t msg_box;
     msg_box.color = GLCD_BLACK;
     msg_box.mode = TEXT_MULTI_LINES;
@@ -226,6 +227,7 @@ static void write_msg(const char *msg)
     msg_box.font = Terminal5x7;
     msg_box.text = msg;
     widget_textbox(hardware_glcds(0), &msg_box);
+    screen_unlock();
 }
 
 
@@ -383,7 +385,12 @@ const char* cli_command(const char *command, uint8_t response_action)
     // take semaphore to wait for response
     if (response_action == CLI_RETRIEVE_RESPONSE)
     {
-        if (xSemaphoreTake(g_response_sem, RESPONSE_TIMEOUT) == pdTRUE)
+        // the cli task draws the restore messages
+        uint8_t depth = screen_lock_release();
+        portBASE_TYPE xReturn = xSemaphoreTake(g_response_sem, RESPONSE_TIMEOUT);
+        screen_lock_restore(depth);
+
+        if (xReturn == pdTRUE)
         {
             g_cli.waiting_response = 0;
             return g_cli.response;
@@ -526,7 +526,7 @@ void widget_toggle(glcd_t *display, toggle_t *toggle)
     }
 }
 
-void widget_knob(glcd_t *display, knob_t *knob)
+uint8_t widget_knob_position(knob_t *knob)
 {
     float NewValue;
     uint8_t knob_possistion = 0;
@@ -564,9 +564,19 @@ void widget_knob(glcd_t *display, knob_t *knob)
     //ERROR
     else
     {
-        return;
+        return KNOB_INVALID_POSITION;
     }
 
+    return knob_possistion;
+}
+
+void widget_knob(glcd_t *display, knob_t *knob)
+{
+    uint8_t knob_possistion = widget_knob_position(knob);
+
+    if (knob_possistion == KNOB_INVALID_POSITION)
+        return;
+
     //draw the circle
     glcd_rect_fill(display, (knob->x - 2) , (knob->y - 5), 5, 1, knob->color);
     glcd_rect_fill(display, (knob->x - 2) , (knob->y + 5), 5, 1, knob->color);
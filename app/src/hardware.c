@@ -33,6 +33,12 @@
 //Timer 3 pols overlay and print if needed
 #define TIMER3_PRIORITY     5
 
+// the DMA fills the pots samples with the conversions of all the ADC channels, half a buffer per transfer
+#define ADC_CHANNELS_COUNT  8
+#define POTS_SAMPLES        (ADC_CHANNELS_COUNT << POT_OVERSAMPLING_SHIFT)
+// the ADC converts a half of the pots samples per actuators clock, so the DMA interrupt runs once per clock
+#define ADC_RATE            ((POTS_SAMPLES / 2) * (1000 / CLOCK_PERIOD))
+
 /*
 ************************************************************************************************************************
 *           LOCAL CONSTANTS
@@ -245,6 +251,11 @@ static int g_brightness;
 static uint32_t g_overlay_counter = 0;
 static uint8_t g_overlay_type = 0, g_trigger_overlay_callback = 0;
 static void (*g_overlay_callback)(void);
+static volatile uint32_t g_pots_samples[POTS_SAMPLES];
+static GPDMA_LLI_Type g_pots_lli[2];
+static uint32_t g_pots_half_sums[2][ADC_CHANNELS_COUNT];
+static uint8_t g_pots_half_counts[2][ADC_CHANNELS_COUNT];
+static volatile uint32_t g_pots_sums[ADC_CHANNELS_COUNT];
 
 /*
 ************************************************************************************************************************
@@ -259,6 +270,9 @@ static void (*g_overlay_callback)(void);
 ************************************************************************************************************************
 */
 
+#if POT_OVERSAMPLING_SHIFT < 1
+#error "POT_OVERSAMPLING_SHIFT must be at least 1, each half of the pots samples holds half of the conversions"
+#endif
 
 /*
 ************************************************************************************************************************
@@ -343,11 +357,16 @@ void check_eeprom_defaults(uint16_t current_version)
                 EEPROM_Read(0, DISPLAY_CONTRAST_LEFT_ADRESS, &read_buffer, MODE_8_BIT, 1);
                 uint8_t write_buffer = read_buffer;
                 EEPROM_Write(0, DISPLAY_CONTRAST_RIGHT_ADRESS, &write_buffer, MODE_8_BIT, 1);
+            // fall through
+            case 1211:
+                //adaptive pot filter tuning was introduced here
+                calibration_write_filter_default();
             break;
             //nothing saved yet, new unit, write all settings
             default:
                 write_o_settings_defaults();
                 calibration_write_default();
+                calibration_write_filter_default();
                 write_led_defaults();
             break;
         }
@@ -363,6 +382,7 @@ void check_eeprom_defaults(uint16_t current_version)
     	//write all settings
     	write_o_settings_defaults();
     	calibration_write_default();
+    	calibration_write_filter_default();
     	write_led_defaults();
     }
 
@@ -404,9 +424,9 @@ void adc_initalisation(void)
   actuator_set_pins(hardware_actuators(POT0 + 7), POT_PINS[7]);
 
   /* Configuration for ADC :
-  *  ADC conversion rate = 400Khz
+  *  ADC conversion rate = 64Khz (64 conversions per 1ms clock)
   */
-  ADC_Init(LPC_ADC, 400000);
+  ADC_Init(LPC_ADC, ADC_RATE);
 
   ADC_IntConfig(LPC_ADC, 0, DISABLE);
   ADC_IntConfig(LPC_ADC, 1, DISABLE);
@@ -429,6 +449,100 @@ void adc_initalisation(void)
   ADC_StartCmd(LPC_ADC, ADC_START_CONTINUOUS);
   ADC_BurstCmd(LPC_ADC, ENABLE);
 }
+
+static void pots_dma_start(void)
+{
+    LPC_GPDMACH_TypeDef *channel = (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (POTS_DMA_CHANNEL * 0x20));
+
+    // the DMA controller is shared with the serials, it is only initialized here when none of them uses it
+    if (!(LPC_SC->PCONP & CLKPWR_PCONP_PCGPDMA)) GPDMA_Init();
+
+    // each half of the samples buffer is a transfer, its terminal count interrupt sums the half
+    GPDMA_Channel_CFG_Type GPDMACfg;
+    GPDMACfg.ChannelNum = POTS_DMA_CHANNEL;
+    GPDMACfg.TransferSize = POTS_SAMPLES / 2;
+    GPDMACfg.TransferWidth = 0;
+    GPDMACfg.SrcMemAddr = 0;
+    GPDMACfg.DstMemAddr = (uint32_t) g_pots_samples;
+    GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+    GPDMACfg.SrcConn = GPDMA_CONN_ADC;
+    GPDMACfg.DstConn = 0;
+    GPDMACfg.DMALLI = (uint32_t) &g_pots_lli[1];
+
+    GPDMA_Setup(&GPDMACfg);
+
+    // the two linked list items point to each other, so the DMA keeps filling both halves
+    g_pots_lli[0].SrcAddr = channel->CSrcAddr;
+    g_pots_lli[0].DstAddr = (uint32_t) g_pots_samples;
+    g_pots_lli[0].NextLLI = (uint32_t) &g_pots_lli[1];
+    g_pots_lli[0].Control = channel->CControl;
+
+    g_pots_lli[1].SrcAddr = channel->CSrcAddr;
+    g_pots_lli[1].DstAddr = (uint32_t) &g_pots_samples[POTS_SAMPLES / 2];
+    g_pots_lli[1].NextLLI = (uint32_t) &g_pots_lli[0];
+    g_pots_lli[1].Control = channel->CControl;
+
+    // the DMA interrupt may not be enabled yet when no serial uses the DMA
+    NVIC_SetPriority(DMA_IRQn, SERIAL_DMA_PRIORITY);
+    NVIC_EnableIRQ(DMA_IRQn);
+
+    // in burst mode each finished channel requests the transfer of the global data register,
+    // this only happens when the global done flag doesn't generate the request
+    ADC_IntConfig(LPC_ADC, ADC_ADGINTEN, DISABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN0, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN1, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN2, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN3, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN4, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN5, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN6, ENABLE);
+    ADC_IntConfig(LPC_ADC, ADC_ADINTEN7, ENABLE);
+
+    GPDMA_ChannelCmd(POTS_DMA_CHANNEL, ENABLE);
+}
+
+// sums the half of the samples buffer the DMA has just filled, then publishes the sums of both halves
+static void pots_dma_handler(void)
+{
+    LPC_GPDMACH_TypeDef *channel = (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (POTS_DMA_CHANNEL * 0x20));
+    uint8_t i, half;
+
+    if (!GPDMA_IntGetStatus(GPDMA_STAT_INT, POTS_DMA_CHANNEL)) return;
+
+    GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, POTS_DMA_CHANNEL);
+    GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, POTS_DMA_CHANNEL);
+
+    // the DMA is already writing the other half
+    half = (channel->CDestAddr < (uint32_t) &g_pots_samples[POTS_SAMPLES / 2]) ? 1 : 0;
+
+    uint32_t *sums = g_pots_half_sums[half];
+    uint8_t *counts = g_pots_half_counts[half];
+    const volatile uint32_t *samples = &g_pots_samples[half * (POTS_SAMPLES / 2)];
+
+    for (i = 0; i < ADC_CHANNELS_COUNT; i++)
+    {
+        sums[i] = 0;
+        counts[i] = 0;
+    }
+
+    for (i = 0; i < (POTS_SAMPLES / 2); i++)
+    {
+        uint32_t sample = samples[i];
+
+        // a conversion which was overrun or not finished
+        if (!(sample & ADC_GDR_DONE_FLAG)) continue;
+
+        sums[ADC_GDR_CH(sample)] += ADC_GDR_RESULT(sample);
+        counts[ADC_GDR_CH(sample)]++;
+    }
+
+    // the channel is only published when the halves hold exactly its 2^shift last conversions
+    for (i = 0; i < ADC_CHANNELS_COUNT; i++)
+    {
+        if ((g_pots_half_counts[0][i] + g_pots_half_counts[1][i]) == (1 << POT_OVERSAMPLING_SHIFT))
+            g_pots_sums[i] = (g_pots_half_sums[0][i] + g_pots_half_sums[1][i]) | HARDWARE_POT_SUM_VALID;
+    }
+}
 /*
 ************************************************************************************************************************
 *           GLOBAL FUNCTIONS
@@ -497,6 +611,8 @@ void hardware_setup(void)
         // pots initialization
         actuator_create(POT, i, hardware_actuators(POT0 + i));
         actuator_set_pins(hardware_actuators(POT0 + i), POT_PINS[i]);
+        actuator_set_prop(hardware_actuators(POT0 + i), POT_MIN_CUTOFF, calibration_get_min_cutoff(i));
+        actuator_set_prop(hardware_actuators(POT0 + i), POT_BETA, calibration_get_beta(i));
     }
     
     //check if the calibration value's are valid, if not write defualts
@@ -673,10 +789,12 @@ void hardware_setup(void)
     g_serial[0].rx_pin = SERIAL0_RX_PIN;
     g_serial[0].rx_function = SERIAL0_RX_FUNC;
     g_serial[0].rx_buffer_size = SERIAL0_RX_BUFF_SIZE;
+    g_serial[0].rx_dma_channel = SERIAL0_RX_DMA_CHANNEL;
     g_serial[0].tx_port = SERIAL0_TX_PORT;
     g_serial[0].tx_pin = SERIAL0_TX_PIN;
     g_serial[0].tx_function = SERIAL0_TX_FUNC;
     g_serial[0].tx_buffer_size = SERIAL0_TX_BUFF_SIZE;
+    g_serial[0].tx_dma_channel = SERIAL0_TX_DMA_CHANNEL;
     g_serial[0].has_oe = SERIAL0_HAS_OE;
     #if SERIAL0_HAS_OE
     g_serial[0].oe_port = SERIAL0_OE_PORT;
@@ -693,10 +811,12 @@ void hardware_setup(void)
     g_serial[1].rx_pin = SERIAL1_RX_PIN;
     g_serial[1].rx_function = SERIAL1_RX_FUNC;
     g_serial[1].rx_buffer_size = SERIAL1_RX_BUFF_SIZE;
+    g_serial[1].rx_dma_channel = SERIAL1_RX_DMA_CHANNEL;
     g_serial[1].tx_port = SERIAL1_TX_PORT;
     g_serial[1].tx_pin = SERIAL1_TX_PIN;
     g_serial[1].tx_function = SERIAL1_TX_FUNC;
     g_serial[1].tx_buffer_size = SERIAL1_TX_BUFF_SIZE;
+    g_serial[1].tx_dma_channel = SERIAL1_TX_DMA_CHANNEL;
     g_serial[1].has_oe = SERIAL1_HAS_OE;
     #if SERIAL1_HAS_OE
     g_serial[1].oe_port = SERIAL1_OE_PORT;
@@ -713,10 +833,12 @@ void hardware_setup(void)
     g_serial[2].rx_pin = SERIAL2_RX_PIN;
     g_serial[2].rx_function = SERIAL2_RX_FUNC;
     g_serial[2].rx_buffer_size = SERIAL2_RX_BUFF_SIZE;
+    g_serial[2].rx_dma_channel = SERIAL2_RX_DMA_CHANNEL;
     g_serial[2].tx_port = SERIAL2_TX_PORT;
     g_serial[2].tx_pin = SERIAL2_TX_PIN;
     g_serial[2].tx_function = SERIAL2_TX_FUNC;
     g_serial[2].tx_buffer_size = SERIAL2_TX_BUFF_SIZE;
+    g_serial[2].tx_dma_channel = SERIAL2_TX_DMA_CHANNEL;
     g_serial[2].has_oe = SERIAL2_HAS_OE;
     #if SERIAL2_HAS_OE
     g_serial[2].oe_port = SERIAL2_OE_PORT;
@@ -733,10 +855,12 @@ void hardware_setup(void)
     g_serial[3].rx_pin = SERIAL3_RX_PIN;
     g_serial[3].rx_function = SERIAL3_RX_FUNC;
     g_serial[3].rx_buffer_size = SERIAL3_RX_BUFF_SIZE;
+    g_serial[3].rx_dma_channel = SERIAL3_RX_DMA_CHANNEL;
     g_serial[3].tx_port = SERIAL3_TX_PORT;
     g_serial[3].tx_pin = SERIAL3_TX_PIN;
     g_serial[3].tx_function = SERIAL3_TX_FUNC;
     g_serial[3].tx_buffer_size = SERIAL3_TX_BUFF_SIZE;
+    g_serial[3].tx_dma_channel = SERIAL3_TX_DMA_CHANNEL;
     g_serial[3].has_oe = SERIAL3_HAS_OE;
     #if SERIAL3_HAS_OE
     g_serial[3].oe_port = SERIAL3_OE_PORT;
@@ -744,6 +868,11 @@ void hardware_setup(void)
     #endif
     serial_init(&g_serial[3]);
     #endif
+
+    ////////////////////////////////////////////////////////////////
+    // Pots acquisition
+    // started after the serials because their DMA initialization resets all channels
+    pots_dma_start();
 }
 
 void hardware_eneble_serial_interupt(uint8_t serial_port)
@@ -808,6 +937,11 @@ uint8_t hardware_get_acceleration(void)
     return actuator_get_acceleration();
 }
 
+const volatile uint32_t *hardware_pots_sums(void)
+{
+    return g_pots_sums;
+}
+
 uint16_t hardware_get_pot_value(uint8_t pot)
 {
     return actuator_pot_value(pot);
@@ -829,6 +963,7 @@ void hardware_reset_eeprom(void)
     //write all settings
     write_o_settings_defaults();
     calibration_write_default();
+    calibration_write_filter_default();
     write_led_defaults();
 
     //update the version 
@@ -926,11 +1061,18 @@ void TIMER0_IRQHandler(void)
     TIM_ClearIntPending(LPC_TIM0, TIM_MR0_INT);
 }
 
+void DMA_IRQHandler(void)
+{
+    serial_dma_handler();
+    pots_dma_handler();
+}
+
 void TIMER1_IRQHandler(void)
 {
     if (TIM_GetIntStatus(LPC_TIM1, TIM_MR1_INT) == SET)
     {
         actuators_clock();
+        serial_rx_dma_poll();
         g_counter++;
     }
 
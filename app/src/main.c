@@ -69,8 +69,7 @@
 */
 
 static volatile xQueueHandle g_actuators_queue;
-static uint8_t g_comm_msg_buffer[WEBGUI_COMM_RX_BUFF_SIZE];
-static uint8_t g_sys_msg_buffer[SYSTEM_COMM_RX_BUFF_SIZE];
+static xSemaphoreHandle g_displays_sem;
 
 /*
 ************************************************************************************************************************
@@ -138,6 +137,22 @@ void serial_error(uint8_t uart_id, uint32_t error)
     UNUSED_PARAM(error);
 }
 
+// this callback is called from the tasks which draw on an up to date display, the displays
+// task is the only one which updates the displays, so the drawing never waits for the SSP
+void uc1701_update_request(uc1701_t *disp)
+{
+    UNUSED_PARAM(disp);
+
+    // the displays can be drawn before the scheduler starts
+    if (g_displays_sem) xSemaphoreGive(g_displays_sem);
+}
+
+// this callback is called when the pedalboards list must be reloaded
+void naveg_pb_list_request(void)
+{
+    if (g_displays_sem) xSemaphoreGive(g_displays_sem);
+}
+
 // this callback is called from a ISR
 static void actuators_cb(void *actuator)
 {
@@ -209,17 +224,21 @@ static void webgui_procotol_task(void *pvParameters)
 
     while (1)
     {
-        uint32_t msg_size;
-        ringbuff_t *rb = ui_comm_webgui_read();
-        msg_size = ringbuff_read_until(rb, g_comm_msg_buffer, WEBGUI_COMM_RX_BUFF_SIZE, 0);
-        // parses the message
+        // a message is queued for each terminator received, so all of them are drained
+        char *data;
+        uint32_t msg_size = ui_comm_webgui_read(&data);
+        // parses the message in place and then releases it
         if (msg_size > 0)
         {
             msg_t msg;
             msg.sender_id = WEBGUI_SERIAL;
-            msg.data = (char *) g_comm_msg_buffer;
+            msg.data = data;
             msg.data_size = msg_size;
+            // the callbacks draw whole screens
+            screen_lock();
             protocol_parse(&msg);
+            screen_unlock();
+            ui_comm_webgui_release(msg_size);
         }
     }
 }
@@ -232,17 +251,21 @@ static void system_procotol_task(void *pvParameters)
 
     while (1)
     {
-        uint32_t msg_size;
-        ringbuff_t *rb = sys_comm_read();
-        msg_size = ringbuff_read_until(rb, g_sys_msg_buffer, SYSTEM_COMM_RX_BUFF_SIZE, 0);
-        // parses the message
+        // a message is queued for each terminator received, so all of them are drained
+        char *data;
+        uint32_t msg_size = sys_comm_read(&data);
+        // parses the message in place and then releases it
         if (msg_size > 0)
         {
             msg_t msg;
             msg.sender_id = SYSTEM_SERIAL;
-            msg.data = (char *) g_sys_msg_buffer;
+            msg.data = data;
             msg.data_size = msg_size;
+            // the callbacks draw whole screens
+            screen_lock();
             protocol_parse(&msg);
+            screen_unlock();
+            sys_comm_release(msg_size);
         }
     }
 }
@@ -251,35 +274,60 @@ static void displays_task(void *pvParameters)
 {
     UNUSED_PARAM(pvParameters);
 
-    uint8_t i = 0;
-    uint32_t count = 0;
+    uint8_t i;
+    uint8_t update_pending = 0;
+    portTickType next_update = 0;
 
     while (1)
     {
-        // update GLCD
-        glcd_update(hardware_glcds(i));
-        if (++i == GLCD_COUNT) i = 0;
-
-        //check if nav mode needs update
-        if (naveg_get_pb_list_update()){
-            naveg_update_pb_list();
-        }
+        portTickType timeout = portMAX_DELAY;
 
-        // I know, this is embarrassing
+        // the navigation screen is refreshed periodically while it needs it
         if (naveg_need_update())
         {
-            if (++count == 500000)
+            portTickType now = xTaskGetTickCount();
+
+            if (!update_pending)
             {
-                naveg_update();
-                count = 0;
+                next_update = now + (NAVEG_UPDATE_TIME / portTICK_RATE_MS);
+                update_pending = 1;
             }
+
+            timeout = ((int32_t) (next_update - now) > 0) ? (next_update - now) : 0;
         }
         else
         {
-            count = 0;
+            update_pending = 0;
         }
 
-        taskYIELD();
+        // sleeps until some display buffer is changed or the navigation refresh is due
+        xSemaphoreTake(g_displays_sem, timeout);
+
+        // the frames take the buffers when no task is in the middle of a screen, then they are sent
+        // without holding the drawing lock
+        screen_lock();
+        for (i = 0; i < GLCD_COUNT; i++)
+            glcd_present(hardware_glcds(i));
+        screen_unlock();
+
+        // update GLCDs
+        for (i = 0; i < GLCD_COUNT; i++)
+            glcd_update(hardware_glcds(i));
+
+        screen_lock();
+
+        //check if nav mode needs update
+        if (naveg_get_pb_list_update()){
+            naveg_update_pb_list();
+        }
+
+        if (update_pending && (int32_t) (xTaskGetTickCount() - next_update) >= 0)
+        {
+            update_pending = 0;
+            if (naveg_need_update()) naveg_update();
+        }
+
+        screen_unlock();
     }
 }
 
@@ -294,8 +342,19 @@ static void actuators_task(void *pvParameters)
     {
         portBASE_TYPE xStatus;
 
-        // take the actuator from queue 
-        xStatus = xQueueReceive(g_actuators_queue, &actuator_info, portMAX_DELAY);
+        // take the actuator from queue, wakes up to flush the pending encoders and pots values
+        xStatus = xQueueReceive(g_actuators_queue, &actuator_info,
+                                naveg_pending_control_values() ? (CONTROL_FLUSH_TIME / portTICK_RATE_MS) : portMAX_DELAY);
+
+        // each event is drawn as a whole
+        screen_lock();
+
+        if (xStatus != pdPASS)
+        {
+            naveg_flush_control_values(1);
+            screen_unlock();
+            continue;
+        }
 
         // check if must enter in the restore mode
         if (cli_restore(RESTORE_STATUS) == NOT_LOGGED)
@@ -317,6 +376,10 @@ static void actuators_task(void *pvParameters)
             // encoders
             if (type == ROTARY_ENCODER)
             {
+                // the detents accumulated since the last event are taken even when they are not used,
+                // otherwise they would all be applied on the first event after calibration mode
+                int8_t delta = ENCODER_TURNED(status) ? actuator_encoder_take_delta(hardware_actuators(ENCODER0 + id)) : 0;
+
                 //we dont use the encoders in calibration mode
                 if (!g_calibration_mode) 
                 {
@@ -333,18 +396,24 @@ static void actuators_task(void *pvParameters)
                     {
                         if (id && naveg_is_master_vol()) naveg_master_volume(id);
                     }
-                    if (ENCODER_TURNED_CW(status))
+                    if (ENCODER_TURNED(status))
                     {
-                        naveg_inc_control(id);
-                        naveg_down(id);
-                    }
-                    if (ENCODER_TURNED_ACW(status))
-                    {
-                        naveg_dec_control(id);
-                        naveg_up(id);
+                        // applies all the detents accumulated since the last event at once,
+                        // the events queued meanwhile have nothing left to apply
+                        uint8_t ticks = (delta > 0) ? delta : -delta;
+
+                        if (delta > 0)
+                        {
+                            naveg_inc_control(id, ticks);
+                            naveg_down(id, ticks);
+                        }
+                        else if (delta < 0)
+                        {
+                            naveg_dec_control(id, ticks);
+                            naveg_up(id, ticks);
+                        }
                     }
                 }
-                glcd_update(hardware_glcds(id));
             }
 
             else if (type == POT)
@@ -361,8 +430,6 @@ static void actuators_task(void *pvParameters)
                         naveg_pot_change(id);
                     }
                 }
-                
-                glcd_update(hardware_glcds((id > 3) ? 1 : 0));
             }
 
             // footswitches
@@ -399,10 +466,21 @@ static void actuators_task(void *pvParameters)
                         if (id > 3) naveg_save_snapshot(id);
                     }
                 }
-
-                glcd_update(hardware_glcds((id > 1) ? 1 : 0));
             }
         }
+        // the encoders events are dropped until the device is booted, and so are their detents
+        else if (actuator_info[0] == ROTARY_ENCODER)
+        {
+            actuator_encoder_take_delta(hardware_actuators(ENCODER0 + actuator_info[1]));
+        }
+
+        // no more events to coalesce, send the values right away if the link is idle
+        if (uxQueueMessagesWaiting(g_actuators_queue) == 0 && ui_comm_webgui_link_idle())
+            naveg_flush_control_values(1);
+        else
+            naveg_flush_control_values(0);
+
+        screen_unlock();
     }
 }
 
@@ -430,6 +508,8 @@ static void post_boot_task(void *pvParameters)
 
     while (1)
     {
+        screen_lock();
+
         if (g_device_booted)
         {
             //set the master volume widget
@@ -440,6 +520,7 @@ static void post_boot_task(void *pvParameters)
                 screen_master_vol(item->data.value);
 
             // deletes itself
+            screen_unlock();
             vTaskDelete(NULL);
         }
 
@@ -447,6 +528,7 @@ static void post_boot_task(void *pvParameters)
         if (cli_restore(RESTORE_STATUS) == NOT_LOGGED)
             cli_restore(RESTORE_CHECK_BOOT);
 
+        screen_unlock();
         taskYIELD();
     }
 }
@@ -455,11 +537,16 @@ static void setup_task(void *pvParameters)
 {
     UNUSED_PARAM(pvParameters);
 
+    // the displays task is woken up through this semaphore
+    vSemaphoreCreateBinary(g_displays_sem);
+    xSemaphoreTake(g_displays_sem, 0);
+
+    // the drawing lock is created before any other task
+    screen_init();
+
     // draw start up images
     screen_image(0, mod_logo); 
-    glcd_update(hardware_glcds(0));
     screen_image(1, mod_duo);
-    glcd_update(hardware_glcds(1));
 
     // CLI initialization
     cli_init();
@@ -571,6 +658,7 @@ void vApplicationStackOverflowHook(xTaskHandle *pxTask, signed portCHAR *pcTaskN
     glcd_clear(glcd0, GLCD_WHITE);
     glcd_text(glcd0, 0, 0, "stack overflow", NULL, GLCD_BLACK);
     glcd_text(glcd0, 0, 10, (const char *) pcTaskName, NULL, GLCD_BLACK);
+    glcd_present(glcd0);
     glcd_update(glcd0);
     ledz_on(hardware_leds(5), CYAN);
     while (1);
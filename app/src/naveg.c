@@ -14,6 +14,7 @@
 #include "ui_comm.h"
 #include "sys_comm.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 #include "actuator.h"
 #include "calibration.h"
@@ -113,6 +114,11 @@ static uint8_t g_scroll_dir = 1;
 static uint8_t g_page_mode = 0;
 static uint8_t g_reboot_value = 0;
 
+// pending encoders and pots values, only the latest value of each actuator is sent
+static float g_pending_values[TOTAL_ACTUATORS];
+static uint32_t g_pending_mask, g_last_flush;
+static uint32_t g_values_sent, g_values_coalesced;
+
 // only disabled after "boot" command received
 bool g_self_test_mode = true;
 bool g_self_test_cancel_button = false;
@@ -142,6 +148,10 @@ static void foot_control_rm(uint8_t hw_id);
 ************************************************************************************************************************
 */
 
+#if TOTAL_ACTUATORS > 32
+#error "the pending control values mask only supports up to 32 actuators"
+#endif
+
 
 /*
 ************************************************************************************************************************
@@ -1061,6 +1071,50 @@ static void send_load_pedalboard(uint16_t bank_id, const char *pedalboard_uid)
     ui_comm_webgui_wait_response();
 }
 
+static void send_control_value(uint8_t hw_id, float value)
+{
+    char buffer[128];
+    uint8_t i;
+
+    i = copy_command(buffer, CMD_CONTROL_SET);
+
+    // insert the hw_id on buffer
+    i += int_to_str(hw_id, &buffer[i], sizeof(buffer) - i, 0);
+    buffer[i++] = ' ';
+
+    // insert the value on buffer
+    i += float_to_str(value, &buffer[i], sizeof(buffer) - i, 6);
+    buffer[i] = 0;
+
+    g_values_sent++;
+
+    if (g_self_test_mode) {
+        ui_comm_webgui_clear_tx_buffer();
+    }
+    // several requests can be in flight, no need to wait for the response
+    else if (ui_comm_webgui_pipeline_enabled()) {
+        ui_comm_webgui_send_tagged(buffer, i, sizeof(buffer), NULL, NULL);
+        return;
+    }
+
+    // send the data to GUI
+    ui_comm_webgui_send(buffer, i);
+
+    //wait for a response from mod-ui
+    if (!g_self_test_mode) {
+        ui_comm_webgui_wait_response();
+    }
+}
+
+static void drop_pending_value(uint8_t hw_id)
+{
+    if (hw_id >= TOTAL_ACTUATORS) return;
+
+    taskENTER_CRITICAL();
+    g_pending_mask &= ~(1UL << hw_id);
+    taskEXIT_CRITICAL();
+}
+
 static void control_set(uint8_t id, control_t *control)
 {
     uint32_t now, delta;
@@ -1276,30 +1330,20 @@ static void control_set(uint8_t id, control_t *control)
         }
     }
 
-    char buffer[128];
-    uint8_t i;
-
-    i = copy_command(buffer, CMD_CONTROL_SET);
-
-    // insert the hw_id on buffer
-    i += int_to_str(control->hw_id, &buffer[i], sizeof(buffer) - i, 0);
-    buffer[i++] = ' ';
-
-    // insert the value on buffer
-    i += float_to_str(control->value, &buffer[i], sizeof(buffer) - i, 6);
-    buffer[i] = 0;
-
-    if (g_self_test_mode) {
-        ui_comm_webgui_clear_tx_buffer();
+    // encoders and pots values are coalesced, the other actuators must not lose any state change
+    if (!g_self_test_mode && !(control->properties & (FLAG_CONTROL_TRIGGER | FLAG_CONTROL_MOMENTARY)) &&
+        (control->hw_id < ENCODERS_COUNT ||
+        (control->hw_id >= (ENCODERS_COUNT + FOOTSWITCHES_ACTUATOR_COUNT) && control->hw_id < TOTAL_ACTUATORS)))
+    {
+        taskENTER_CRITICAL();
+        if (g_pending_mask & (1UL << control->hw_id)) g_values_coalesced++;
+        g_pending_values[control->hw_id] = control->value;
+        g_pending_mask |= (1UL << control->hw_id);
+        taskEXIT_CRITICAL();
+        return;
     }
 
-    // send the data to GUI
-    ui_comm_webgui_send(buffer, i);
-
-    //wait for a response from mod-ui
-    if (!g_self_test_mode) {
-        ui_comm_webgui_wait_response();
-    }
+    send_control_value(control->hw_id, control->value);
 }
 
 static void bp_enter(void)
@@ -2329,6 +2373,8 @@ void naveg_remove_control(uint8_t hw_id)
 {
     if (!g_initialized) return;
 
+    drop_pending_value(hw_id);
+
     if (hw_id < ENCODERS_COUNT)
     {
         display_encoder_rm(hw_id);
@@ -2343,7 +2389,7 @@ void naveg_remove_control(uint8_t hw_id)
     }
 }
 
-void naveg_inc_control(uint8_t display)
+void naveg_inc_control(uint8_t display, uint8_t steps)
 {
     if (!g_initialized) return;
 
@@ -2351,23 +2397,30 @@ void naveg_inc_control(uint8_t display)
     if ((display_has_tool_enabled(display)) || g_self_test_mode) return;
 
     control_t *control = g_encoders[display];
-    if (!control) return;
+    if (!control || steps == 0) return;
 
     if  ((control->properties & (FLAG_CONTROL_ENUMERATION | FLAG_CONTROL_SCALE_POINTS | FLAG_CONTROL_REVERSE)))
     {
-    	//check/sets the direction
+    	//check/sets the direction, this takes one step
 		if (control->scroll_dir == 0)
 		{
 		    control->scroll_dir = 1;
-		    control_set(display, control);
-		    return;
+		    if (--steps == 0)
+		    {
+		        control_set(display, control);
+		        return;
+		    }
 		}
 
         if (control->scale_points_flag & FLAG_SCALEPOINT_PAGINATED)
         {
         	// increments the step
         	if (control->step < (control->steps - 2))
-        	    control->step++;
+        	{
+        	    control->step += steps;
+        	    if (control->step > (control->steps - 2))
+        	        control->step = control->steps - 2;
+        	}
         	else
         	{
         	    //request new data, a new control we be assigned after
@@ -2381,7 +2434,11 @@ void naveg_inc_control(uint8_t display)
     	{
     		// increments the step
     		if (control->step < (control->steps - 1))
-    		    control->step++;
+    		{
+    		    control->step += steps;
+    		    if (control->step > (control->steps - 1))
+    		        control->step = control->steps - 1;
+    		}
     		else
     		    return;	
     	}
@@ -2404,7 +2461,11 @@ void naveg_inc_control(uint8_t display)
     {
         // increments the step
         if (control->step < (control->steps - 1))
-            control->step++;
+        {
+            control->step += steps;
+            if (control->step > (control->steps - 1))
+                control->step = control->steps - 1;
+        }
         else
             return;
     }
@@ -2415,7 +2476,7 @@ void naveg_inc_control(uint8_t display)
     control_set(display, control);
 }
 
-void naveg_dec_control(uint8_t display)
+void naveg_dec_control(uint8_t display, uint8_t steps)
 {
     if (!g_initialized) return;
 
@@ -2423,16 +2484,19 @@ void naveg_dec_control(uint8_t display)
     if ((display_has_tool_enabled(display)) || g_self_test_mode) return;
 
     control_t *control = g_encoders[display];
-    if (!control) return;
+    if (!control || steps == 0) return;
 
     if  ((control->properties & (FLAG_CONTROL_ENUMERATION | FLAG_CONTROL_SCALE_POINTS | FLAG_CONTROL_REVERSE)))
     {
-		//check/sets the direction
+		//check/sets the direction, this takes one step
 		if (control->scroll_dir != 0)
 		{
 		    control->scroll_dir = 0;
-		    control_set(display, control);
-		    return;
+		    if (--steps == 0)
+		    {
+		        control_set(display, control);
+		        return;
+		    }
 		}
 
         if (control->scale_points_flag & FLAG_SCALEPOINT_PAGINATED)
@@ -2440,7 +2504,11 @@ void naveg_dec_control(uint8_t display)
 
         	// decrements the step
         	if (control->step > 1)
-        	    control->step--;
+        	{
+        	    control->step -= steps;
+        	    if (control->step < 1)
+        	        control->step = 1;
+        	}
         	else
         	{
         		//temporaraly change to add the right direction on parsing the new page
@@ -2460,7 +2528,11 @@ void naveg_dec_control(uint8_t display)
     	{
             // decrements the step
             if (control->step > 0)
-                control->step--;
+            {
+                control->step -= steps;
+                if (control->step < 0)
+                    control->step = 0;
+            }
             else
                 return;
     	}
@@ -2483,7 +2555,11 @@ void naveg_dec_control(uint8_t display)
     {
         // decrements the step
         if (control->step > 0)
-            control->step--;
+        {
+            control->step -= steps;
+            if (control->step < 0)
+                control->step = 0;
+        }
         else
             return;
     }
@@ -2522,6 +2598,9 @@ void naveg_set_control(uint8_t hw_id, float value)
 
     if (control)
     {
+        // the value set by mod-ui is newer than any pending one
+        drop_pending_value(hw_id);
+
         control->value = value;
         if (value < control->minimum)
             control->value = control->minimum;
@@ -2907,6 +2986,41 @@ void naveg_pot_change(uint8_t pot)
    	control_set(pot, g_pots[pot]);
 }
 
+uint32_t naveg_pending_control_values(void)
+{
+    return g_pending_mask;
+}
+
+void naveg_flush_control_values(uint8_t force)
+{
+    uint8_t hw_id;
+    uint32_t mask;
+    float values[TOTAL_ACTUATORS];
+
+    if (!g_pending_mask) return;
+    if (!force && (hardware_timestamp() - g_last_flush) < CONTROL_FLUSH_TIME) return;
+
+    taskENTER_CRITICAL();
+    mask = g_pending_mask;
+    g_pending_mask = 0;
+    memcpy(values, g_pending_values, sizeof(values));
+    taskEXIT_CRITICAL();
+
+    for (hw_id = 0; hw_id < TOTAL_ACTUATORS; hw_id++)
+    {
+        if (mask & (1UL << hw_id))
+            send_control_value(hw_id, values[hw_id]);
+    }
+
+    g_last_flush = hardware_timestamp();
+}
+
+void naveg_control_values_stats(uint32_t *sent, uint32_t *coalesced)
+{
+    if (sent) *sent = g_values_sent;
+    if (coalesced) *coalesced = g_values_coalesced;
+}
+
 void naveg_foot_change(uint8_t foot, uint8_t pressed)
 {
     if (!g_initialized) return;
@@ -3591,9 +3705,9 @@ void naveg_enter(uint8_t display)
     }
 }
 
-void naveg_up(uint8_t display)
+void naveg_up(uint8_t display, uint8_t steps)
 {
-    if (!g_initialized) return;
+    if (!g_initialized || steps == 0) return;
 
     //if in selftest mode, we just send if we are working or not
     if ((g_self_test_mode) && !g_dialog_active)
@@ -3627,7 +3741,7 @@ void naveg_up(uint8_t display)
            			tool_on(DISPLAY_TOOL_SYSTEM_SUBMENU, 1);
            			g_current_menu = g_current_main_menu;
             		g_current_item = g_current_main_item;
-           			menu_up(display);
+           			while (steps--) menu_up(display);
            			menu_enter(display);
            	}
             else if (tool_is_on(DISPLAY_TOOL_SYSTEM))
@@ -3638,25 +3752,26 @@ void naveg_up(uint8_t display)
            			g_current_main_menu = g_current_menu;
            			g_current_main_item = g_current_item;
            		}
-           		menu_up(display);
+           		// only the item where the steps end is entered
+           		while (steps--) menu_up(display);
            		if (g_dialog_active == false)menu_enter(display);
            	}
         }
         else if (display == 1)
         {
-        	if (tool_is_on (DISPLAY_TOOL_MASTER_VOL)) naveg_set_master_volume(1);
-            else if (tool_is_on(DISPLAY_TOOL_NAVIG)) bp_up();
+        	if (tool_is_on (DISPLAY_TOOL_MASTER_VOL)) while (steps--) naveg_set_master_volume(1);
+            else if (tool_is_on(DISPLAY_TOOL_NAVIG)) while (steps--) bp_up();
             else if (tool_is_on(DISPLAY_TOOL_SYSTEM_SUBMENU))
             {
-             	if ((g_current_menu != g_menu) || (g_current_item->desc->id != ROOT_ID)) menu_up(display);
+             	if ((g_current_menu != g_menu) || (g_current_item->desc->id != ROOT_ID)) while (steps--) menu_up(display);
             }
         }
     }
 }
 
-void naveg_down(uint8_t display)
+void naveg_down(uint8_t display, uint8_t steps)
 {
-    if (!g_initialized) return;
+    if (!g_initialized || steps == 0) return;
 
     //if in selftest mode, we just send if we are working or not
     if ((g_self_test_mode) && !g_dialog_active)
@@ -3690,7 +3805,7 @@ void naveg_down(uint8_t display)
            			tool_on(DISPLAY_TOOL_SYSTEM_SUBMENU, 1);
                     g_current_menu = g_current_main_menu;
                     g_current_item = g_current_main_item;
-           			menu_down(display);
+           			while (steps--) menu_down(display);
            			menu_enter(display);
            	}
             else if (tool_is_on(DISPLAY_TOOL_SYSTEM))
@@ -3700,17 +3815,18 @@ void naveg_down(uint8_t display)
            			g_current_main_menu = g_current_menu;
            			g_current_main_item = g_current_item;
            		}
-           		menu_down(display);
+           		// only the item where the steps end is entered
+           		while (steps--) menu_down(display);
            		if (g_dialog_active == false) menu_enter(display);
            	}
         }
         else if (display == 1)
         {
-        	if (tool_is_on (DISPLAY_TOOL_MASTER_VOL)) naveg_set_master_volume(0);
-            else if (tool_is_on(DISPLAY_TOOL_NAVIG)) bp_down();
+        	if (tool_is_on (DISPLAY_TOOL_MASTER_VOL)) while (steps--) naveg_set_master_volume(0);
+            else if (tool_is_on(DISPLAY_TOOL_NAVIG)) while (steps--) bp_down();
             else if (tool_is_on(DISPLAY_TOOL_SYSTEM_SUBMENU))
             {
-            	if ((g_current_menu != g_menu) || (g_current_item->desc->id != ROOT_ID)) menu_down(display);
+            	if ((g_current_menu != g_menu) || (g_current_item->desc->id != ROOT_ID)) while (steps--) menu_down(display);
             }
         }
     }
@@ -3757,6 +3873,7 @@ void naveg_set_active_pedalboard(uint8_t pedalboard_index)
 void naveg_set_pb_list_update(void)
 {
     g_pedalboards_need_update = true;
+    naveg_pb_list_request();
 }
 
 bool naveg_get_pb_list_update(void)
@@ -3818,7 +3935,12 @@ uint8_t naveg_dialog(const char *msg, char *title)
     //force device being booted, as mod-ui wont notify in selftest mode
     g_device_booted = true;
 
-    if (xSemaphoreTake(g_dialog_sem, portMAX_DELAY) == pdTRUE)
+    // the dialog is answered from the actuators task, which draws
+    uint8_t depth = screen_lock_release();
+    portBASE_TYPE xReturn = xSemaphoreTake(g_dialog_sem, portMAX_DELAY);
+    screen_lock_restore(depth);
+
+    if (xReturn == pdTRUE)
     {
         g_dialog_active = 0;
         display_disable_all_tools(DISPLAY_LEFT);
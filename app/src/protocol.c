@@ -31,6 +31,13 @@
 #define FEW_ARGUMENTS       (-3)
 #define INVALID_ARGUMENT    (-4)
 
+// commands registered on top of the ones defined by mod-protocol
+#define EXTRA_COMMANDS_COUNT    5
+#define COMMANDS_COUNT          (COMMAND_COUNT_DUOX + EXTRA_COMMANDS_COUNT)
+
+// size of the commands dispatch index, must be a power of two
+#define DISPATCH_INDEX_SIZE 128
+
 
 /*
 ************************************************************************************************************************
@@ -76,7 +83,14 @@ typedef struct CMD_T {
 */
 
 static unsigned int g_command_count = 0;
-static cmd_t g_commands[COMMAND_COUNT_DUOX];
+static cmd_t g_commands[COMMANDS_COUNT];
+
+// maps the hash of the command first token to (command index + 1), zero means empty slot
+static uint8_t g_dispatch_index[DISPATCH_INDEX_SIZE];
+
+// tokens of the message being parsed, NULL terminated
+static char *g_webgui_tokens[PROTOCOL_STATIC_ARGUMENTS + 1];
+static char *g_system_tokens[PROTOCOL_STATIC_ARGUMENTS + 1];
 
 static int8_t *WIDGET_LED_COLORS[]  = {
 #ifdef WIDGET_LED0_COLOR
@@ -118,6 +132,14 @@ static int8_t *WIDGET_LED_COLORS[]  = {
 ************************************************************************************************************************
 */
 
+#if (DISPATCH_INDEX_SIZE & (DISPATCH_INDEX_SIZE - 1)) != 0
+#error "DISPATCH_INDEX_SIZE must be a power of two"
+#endif
+
+#if DISPATCH_INDEX_SIZE < (2 * COMMANDS_COUNT)
+#error "DISPATCH_INDEX_SIZE must be at least twice COMMANDS_COUNT"
+#endif
+
 
 /*
 ************************************************************************************************************************
@@ -131,6 +153,90 @@ static int is_wildcard(const char *str)
     return 0;
 }
 
+static uint32_t dispatch_hash(const char *str)
+{
+    uint32_t hash = 5381;
+
+    while (*str)
+        hash = ((hash << 5) + hash) + (uint8_t) *str++;
+
+    return hash;
+}
+
+static void dispatch_insert(uint32_t cmd_index)
+{
+    const char *key = g_commands[cmd_index].list[0];
+    uint32_t slot = dispatch_hash(key) & (DISPATCH_INDEX_SIZE - 1);
+
+    // linear probing, the first registered command keeps the key
+    while (g_dispatch_index[slot])
+    {
+        if (strcmp(g_commands[g_dispatch_index[slot] - 1].list[0], key) == 0) return;
+        slot = (slot + 1) & (DISPATCH_INDEX_SIZE - 1);
+    }
+
+    g_dispatch_index[slot] = cmd_index + 1;
+}
+
+static int32_t dispatch_lookup(const char *key)
+{
+    uint32_t slot = dispatch_hash(key) & (DISPATCH_INDEX_SIZE - 1);
+
+    while (g_dispatch_index[slot])
+    {
+        uint32_t cmd_index = g_dispatch_index[slot] - 1;
+        if (strcmp(g_commands[cmd_index].list[0], key) == 0) return cmd_index;
+        slot = (slot + 1) & (DISPATCH_INDEX_SIZE - 1);
+    }
+
+    return NOT_FOUND;
+}
+
+// checks the arguments of the received message against the command definition
+static int32_t match_command(uint32_t cmd_index, const proto_t *proto)
+{
+    const cmd_t *cmd = &g_commands[cmd_index];
+    uint32_t j, match = 1, variable_arguments = 0;
+
+    // the first token was already matched by the dispatch index
+    for (j = 1; j < proto->list_count && j < cmd->count; j++)
+    {
+        if (strcmp(cmd->list[j], proto->list[j]) == 0)
+        {
+            match++;
+        }
+        else if (is_wildcard(cmd->list[j]))
+        {
+            match++;
+        }
+        else if (strcmp(cmd->list[j], "...") == 0)
+        {
+            match++;
+            variable_arguments = 1;
+        }
+    }
+
+    // checks if the last argument is ...
+    if (j < cmd->count)
+    {
+        if (strcmp(cmd->list[j], "...") == 0) variable_arguments = 1;
+    }
+
+    // few arguments
+    if (proto->list_count < (cmd->count - variable_arguments))
+        return FEW_ARGUMENTS;
+
+    // many arguments
+    if (proto->list_count > cmd->count && !variable_arguments)
+        return MANY_ARGUMENTS;
+
+    // arguments match
+    if (match == proto->list_count || variable_arguments)
+        return cmd_index;
+
+    return NOT_FOUND;
+}
+
 
 /*
 ************************************************************************************************************************
@@ -140,78 +246,52 @@ static int is_wildcard(const char *str)
 
 void protocol_parse(msg_t *msg)
 {
-    uint32_t i, j;
-    int32_t index = NOT_FOUND;
+    int32_t index;
     proto_t proto;
+    char **heap_tokens = NULL;
 
-    proto.list = strarr_split(msg->data, ' ');
-    proto.list_count = strarr_length(proto.list);
+    // each sender is parsed by its own task, so each one has its own tokens list
+    proto.list = (msg->sender_id == SYSTEM_SERIAL) ? g_system_tokens : g_webgui_tokens;
+    proto.list_count = strarr_split_static(msg->data, ' ', proto.list, PROTOCOL_STATIC_ARGUMENTS + 1);
     proto.response = NULL;
 
     // TODO: check invalid argumets (wildcards)
 
     if (proto.list_count == 0)
-    {
-        FREE(proto.list);
         return;
-    }
-
-    unsigned int match, variable_arguments = 0;
 
-    // loop all registered commands
-    for (i = 0; i < g_command_count; i++)
+    // the message was split in place anyway, its tokens follow each other separated by the null chars
+    if (proto.list_count > PROTOCOL_STATIC_ARGUMENTS && proto.list_count <= PROTOCOL_MAX_ARGUMENTS)
     {
-        match = 0;
-        index = NOT_FOUND;
-
-        // checks received protocol
-        for (j = 0; j < proto.list_count && j < g_commands[i].count; j++)
+        heap_tokens = (char **) MALLOC((proto.list_count + 1) * sizeof(char *));
+        if (heap_tokens)
         {
-            if (strcmp(g_commands[i].list[j], proto.list[j]) == 0)
-            {
-                match++;
-            }
-            else if (match > 0)
-            {
-                if (is_wildcard(g_commands[i].list[j])) match++;
-                else if (strcmp(g_commands[i].list[j], "...") == 0)
-                {
-                    match++;
-                    variable_arguments = 1;
-                }
-            }
-        }
-
-        if (match > 0)
-        {
-            // checks if the last argument is ...
-            if (j < g_commands[i].count)
-            {
-                if (strcmp(g_commands[i].list[j], "...") == 0) variable_arguments = 1;
-            }
+            uint32_t i;
+            char *token = proto.list[0];
 
-            // few arguments
-            if (proto.list_count < (g_commands[i].count - variable_arguments))
+            for (i = 0; i < proto.list_count; i++)
             {
-                index = FEW_ARGUMENTS;
+                heap_tokens[i] = token;
+                token += strlen(token) + 1;
             }
+            heap_tokens[i] = NULL;
 
-            // many arguments
-            else if (proto.list_count > g_commands[i].count && !variable_arguments)
-            {
-                index = MANY_ARGUMENTS;
-            }
-
-            // arguments match
-            else if (match == proto.list_count || variable_arguments)
-            {
-                index = i;
-            }
-
-            break;
+            proto.list = heap_tokens;
         }
     }
 
+    // finds the command by its first token, the message is refused if its tokens couldn't be listed
+    if (proto.list_count > PROTOCOL_MAX_ARGUMENTS || (proto.list_count > PROTOCOL_STATIC_ARGUMENTS && !heap_tokens))
+    {
+        index = MANY_ARGUMENTS;
+    }
+    else
+    {
+        index = dispatch_lookup(proto.list[0]);
+        if (index >= 0)
+            index = match_command(index, &proto);
+    }
+
     // Protocol OK
     if (index >= 0)
     {
@@ -235,19 +315,20 @@ void protocol_parse(msg_t *msg)
         SEND_TO_SENDER(msg->sender_id, g_error_messages[-index-1], strlen(g_error_messages[-index-1]));
     }
 
-    FREE(proto.list);
+    if (heap_tokens) FREE(heap_tokens);
 }
 
 
 void protocol_add_command(const char *command, void (*callback)(uint8_t serial_id, proto_t *proto))
 {
-    if (g_command_count >= COMMAND_COUNT_DUOX) while (1);
+    if (g_command_count >= COMMANDS_COUNT) while (1);
 
     char *cmd = str_duplicate(command);
     g_commands[g_command_count].command = cmd;
     g_commands[g_command_count].list = strarr_split(cmd, ' ');
     g_commands[g_command_count].count = strarr_length(g_commands[g_command_count].list);
     g_commands[g_command_count].callback = callback;
+    dispatch_insert(g_command_count);
     g_command_count++;
 }
 
@@ -289,6 +370,9 @@ void protocol_remove_commands(void)
         FREE(g_commands[i].command);
         FREE(g_commands[i].list);
     }
+
+    g_command_count = 0;
+    memset(g_dispatch_index, 0, sizeof(g_dispatch_index));
 }
 
 //initialize all protocol commands
@@ -331,6 +415,11 @@ void protocol_init(void)
     protocol_add_command(CMD_SYS_CHANGE_VALUE, cb_change_assigment_value);
     protocol_add_command(CMD_SYS_CHANGE_WIDGET_INDICATOR, cb_change_widget_indicator);
     protocol_add_command(CMD_PEDALBOARD_CHANGE, cb_pedalboard_change);
+    protocol_add_command(CMD_TAGGED_RESPONSE, cb_tagged_resp);
+    protocol_add_command(CMD_PIPELINE, cb_pipeline);
+    protocol_add_command(CMD_CONTROL_STATS, cb_control_stats);
+    protocol_add_command(CMD_POT_FILTER_SET, cb_pot_filter_set);
+    protocol_add_command(CMD_POT_FILTER_GET, cb_pot_filter_get);
 }
 
 /*
@@ -420,6 +509,7 @@ void cb_glcd_draw(uint8_t serial_id, proto_t *proto)
 
     str_to_hex(proto->list[4], msg_buffer, sizeof(msg_buffer));
     glcd_draw_image(hardware_glcds(glcd_id), x, y, msg_buffer, GLCD_BLACK);
+    screen_invalidate(glcd_id);
 }
 
 void cb_gui_connection(uint8_t serial_id, proto_t *proto)
@@ -429,6 +519,9 @@ void cb_gui_connection(uint8_t serial_id, proto_t *proto)
     //clear the buffer so we dont send any messages
     ui_comm_webgui_clear_tx_buffer();
 
+    //the pipelined mode needs to be negotiated again
+    ui_comm_webgui_set_pipeline_window(0);
+
     if (strcmp(proto->list[0], CMD_GUI_CONNECTED) == 0)
         naveg_ui_connection(UI_CONNECTED);
     else
@@ -521,6 +614,86 @@ void cb_resp(uint8_t serial_id, proto_t *proto)
         ui_comm_webgui_response_cb(proto->list);
 }
 
+void cb_tagged_resp(uint8_t serial_id, proto_t *proto)
+{
+    if (serial_id != WEBGUI_SERIAL)
+        return;
+
+    ui_comm_webgui_tagged_response_cb(atoi(proto->list[1]), proto->list);
+}
+
+void cb_pipeline(uint8_t serial_id, proto_t *proto)
+{
+    if (serial_id != WEBGUI_SERIAL)
+        return;
+
+    uint8_t window = ui_comm_webgui_set_pipeline_window(atoi(proto->list[1]));
+
+    protocol_send_response(CMD_RESPONSE, window, proto);
+}
+
+void cb_control_stats(uint8_t serial_id, proto_t *proto)
+{
+    UNUSED_PARAM(serial_id);
+
+    char buffer[32];
+    uint32_t sent, coalesced;
+    uint8_t i;
+
+    naveg_control_values_stats(&sent, &coalesced);
+
+    i = copy_command(buffer, CMD_RESPONSE);
+    i += int_to_str(0, &buffer[i], sizeof(buffer) - i, 0);
+    buffer[i++] = ' ';
+    i += int_to_str(sent, &buffer[i], sizeof(buffer) - i, 0);
+    buffer[i++] = ' ';
+    int_to_str(coalesced, &buffer[i], sizeof(buffer) - i, 0);
+
+    protocol_response(buffer, proto);
+}
+
+void cb_pot_filter_set(uint8_t serial_id, proto_t *proto)
+{
+    UNUSED_PARAM(serial_id);
+
+    char buffer[20];
+    uint8_t i;
+
+    uint8_t done = calibration_set_filter(atoi(proto->list[1]), atoi(proto->list[2]), atoi(proto->list[3]));
+
+    //-1 when the pot doesn't exist
+    i = copy_command(buffer, CMD_RESPONSE);
+    int_to_str(done ? 0 : -1, &buffer[i], sizeof(buffer) - i, 0);
+
+    protocol_response(buffer, proto);
+}
+
+void cb_pot_filter_get(uint8_t serial_id, proto_t *proto)
+{
+    UNUSED_PARAM(serial_id);
+
+    char buffer[20];
+    uint8_t pot = atoi(proto->list[1]);
+    uint8_t i;
+
+    i = copy_command(buffer, CMD_RESPONSE);
+
+    if (pot >= POTS_COUNT)
+    {
+        int_to_str(-1, &buffer[i], sizeof(buffer) - i, 0);
+        protocol_response(buffer, proto);
+        return;
+    }
+
+    i += int_to_str(0, &buffer[i], sizeof(buffer) - i, 0);
+    buffer[i++] = ' ';
+    i += int_to_str(calibration_get_min_cutoff(pot), &buffer[i], sizeof(buffer) - i, 0);
+    buffer[i++] = ' ';
+    int_to_str(calibration_get_beta(pot), &buffer[i], sizeof(buffer) - i, 0);
+
+    protocol_response(buffer, proto);
+}
+
 void cb_restore(uint8_t serial_id, proto_t *proto)
 {
     UNUSED_PARAM(serial_id);
@@ -17,6 +17,9 @@
 #include "cli.h"
 #include "mod-protocol.h"
 
+#include "FreeRTOS.h"
+#include "semphr.h"
+
 /*
 ************************************************************************************************************************
 *           LOCAL DEFINES
@@ -31,6 +34,8 @@
 #define FOOTER_NAME_WIDTH       ((DISPLAY_WIDTH * 50)/100)
 #define FOOTER_VALUE_WIDTH      (DISPLAY_WIDTH - FOOTER_NAME_WIDTH)
 
+#define SCREEN_FOOTERS_COUNT    4
+
 enum {BANKS_LIST, PEDALBOARD_LIST};
 /*
 ************************************************************************************************************************
@@ -45,6 +50,18 @@ enum {BANKS_LIST, PEDALBOARD_LIST};
 ************************************************************************************************************************
 */
 
+enum {WIDGET_BLANK, WIDGET_TOGGLE, WIDGET_KNOB, WIDGET_INTEGER, WIDGET_BAR, WIDGET_FOOTER};
+
+// inputs of the last drawing of a widget slot, the texts are kept as they were displayed
+typedef struct WIDGET_CACHE_T {
+    uint8_t valid, type, hide, position;
+    int16_t property;
+    int32_t step, steps;
+    char label[25];
+    char value[16];
+    char unit[16];
+} widget_cache_t;
+
 
 /*
 ************************************************************************************************************************
@@ -62,6 +79,8 @@ enum {BANKS_LIST, PEDALBOARD_LIST};
 
 static tuner_t g_tuner = {0, NULL, 0, 1};
 static uint8_t g_hide_non_assigned_actuators = 0;
+static widget_cache_t g_pot_cache[POTS_COUNT], g_encoder_cache[ENCODERS_COUNT], g_footer_cache[SCREEN_FOOTERS_COUNT];
+static xSemaphoreHandle g_drawing_mutex;
 
 
 /*
@@ -84,12 +103,214 @@ static uint8_t g_hide_non_assigned_actuators = 0;
 ************************************************************************************************************************
 */
 
+static void cache_key_init(widget_cache_t *key)
+{
+    // the keys are compared as a whole, so the unused bytes must be zeroed
+    memset(key, 0, sizeof(widget_cache_t));
+    key->valid = 1;
+    key->hide = g_hide_non_assigned_actuators;
+}
+
+static void cache_text(char *dest, const char *src, uint8_t size)
+{
+    if (src) strncpy(dest, src, size);
+}
+
+// returns 1 if the slot already shows what the key describes, otherwise stores the key
+static uint8_t widget_cached(widget_cache_t *cache, const widget_cache_t *key)
+{
+    if (cache->valid && memcmp(cache, key, sizeof(widget_cache_t)) == 0)
+        return 1;
+
+    *cache = *key;
+    return 0;
+}
+
+// formats the value shown by a pot, at most 5 chars
+static void pot_value_text(control_t *control, char *value_str_bfr)
+{
+    //value_str is our temporary value which we use for what kind of value representation we need
+    //value_str_bfr is the value that gets printed
+    char value_str[10] = {0};
+
+    if (!control->value_string) {
+        //if the value becomes bigger then 9999 (4 characters), then switch to another view 10999 becomes 10.9K
+        if (control->value > 9999) {
+            float_to_str((control->value/1000), value_str, sizeof(value_str), 1);
+            strcat(value_str, "K");
+        }
+        //else if we have a value bigger then 100, we dont display decimals anymore
+        else if (control->value > 99.9) {
+        	if (control->value > 999.9) {
+		  		int_to_str(control->value, value_str, sizeof(value_str), 0);
+        	}
+        	else {
+                //not for ints or percantages
+                if ((control->properties & FLAG_CONTROL_INTEGER) || (!strcmp(control->unit, "%"))) {
+                    int_to_str(control->value, value_str, sizeof(value_str), 0);
+                }
+                else {    
+                	float_to_str((control->value), value_str, sizeof(value_str), 1);
+                }
+        	}
+        }
+        //else if we have a value bigger then 10 we display just one decimal
+        else if (control->value > 9.9) {
+            //not for ints
+            if (control->properties & FLAG_CONTROL_INTEGER) {
+                int_to_str(control->value, value_str, sizeof(value_str), 0);
+            }
+            else {
+                float_to_str((control->value), value_str, sizeof(value_str), 6);
+            }
+        }
+        //if the value becomes less then 0 we change to 1 or 0 decimals
+        else if (control->value < 0) {
+            if (control->value > -99.9) {
+                //not for ints
+                if (control->properties & FLAG_CONTROL_INTEGER) {
+                    int_to_str(control->value, value_str, sizeof(value_str), 0);
+                }
+                else if (control->value < -9.9) {
+                    float_to_str((control->value), value_str, sizeof(value_str), 1);
+                }
+                else {
+                    float_to_str((control->value), value_str, sizeof(value_str), 2);
+                }
+            }
+            else {
+                if (control->value < -9999.9) {
+                    int_to_str(control->value/1000, value_str, sizeof(value_str), 0);
+                    strcat(value_str, "K");
+                }
+            	int_to_str(control->value, value_str, sizeof(value_str), 0);
+            }
+        }
+        //for values between 0 and 10 display 2 decimals
+        else {
+            //not for ints
+            if (control->properties & FLAG_CONTROL_INTEGER) {
+                int_to_str(control->value, value_str, sizeof(value_str), 0);
+            }
+            else {
+                float_to_str((control->value), value_str, sizeof(value_str), 6);
+            }
+        }
+
+        //copy to value_str_bfr, the first 5 char
+        strncpy(value_str_bfr, value_str, 5);
+        //terminate the text with line ending, since no unit is added to it
+        value_str_bfr[5] = '\0';
+    }
+    else
+    {
+        //draw the value string
+        uint8_t char_cnt_value = strlen(control->value_string);
+
+        if (char_cnt_value > 5)
+            char_cnt_value = 5;
+
+        control->value_string[char_cnt_value] = '\0';
+        strcpy(value_str_bfr, control->value_string);
+        value_str_bfr[char_cnt_value] = '\0';
+    }
+}
+
+// formats the value shown by an encoder, at most 10 chars
+static void encoder_value_text(control_t *control, char *value_str_bfr)
+{
+    if (!control->value_string) {
+        //convert value
+        //value_str is our temporary value which we use for what kind of value representation we need
+        //value_str_bfr is the value that gets printed
+        char value_str[10] = {0};
+
+        //if the value becomes bigger then 9999 (4 characters), then switch to another view 10999 becomes 10.9K
+        if (control->value > 9999) {
+            int_to_str(control->value/1000, value_str, sizeof(value_str) - 1, 0);
+            strcat(value_str, "K");
+        }
+        //else if we have a value bigger then 100, we dont display decimals anymore
+        else if (control->value > 99.9) {
+            int_to_str(control->value, value_str, sizeof(value_str), 0);
+        }
+        //else if we have a value bigger then 10 we display just one decimal
+        else if (control->value > 9.9) {
+            float_to_str((control->value), value_str, sizeof(value_str), 1);
+        }
+        //if the value becomes less then 0 we change to 1 or 0 decimals
+        else if (control->value < 0) {
+            if (control->value > -99.9) {
+                float_to_str(control->value, value_str, sizeof(value_str), 1);
+            }
+            else if (control->value < -9999.9) {
+                int_to_str((control->value/1000), value_str, sizeof(value_str) - 1, 0);
+                strcat(value_str, "K");
+            }
+            else int_to_str(control->value, value_str, sizeof(value_str), 0);
+        }
+        //for values between 0 and 10 display 2 decimals
+        else {
+            float_to_str(control->value, value_str, sizeof(value_str), 2);
+        }
+
+        //copy to value_str_bfr, the first 5 char
+        strncpy(value_str_bfr, value_str, 5);
+        //terminate the text with line ending
+        value_str_bfr[5] ='\0';
+    }
+    else {
+        //draw the value string
+        uint8_t char_cnt_value = strlen(control->value_string);
+
+        if (char_cnt_value > 10)
+            char_cnt_value = 10;
+
+        control->value_string[char_cnt_value] = '\0';
+        strcpy(value_str_bfr, control->value_string);
+        value_str_bfr[char_cnt_value] = '\0';
+    }
+}
+
 /*
 ************************************************************************************************************************
 *           GLOBAL FUNCTIONS
 ************************************************************************************************************************
 */
 
+void screen_init(void)
+{
+    g_drawing_mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+void screen_lock(void)
+{
+    // the start up images are drawn before the lock exists
+    if (g_drawing_mutex) xSemaphoreTakeRecursive(g_drawing_mutex, portMAX_DELAY);
+}
+
+void screen_unlock(void)
+{
+    if (g_drawing_mutex) xSemaphoreGiveRecursive(g_drawing_mutex);
+}
+
+uint8_t screen_lock_release(void)
+{
+    uint8_t depth = 0;
+
+    // the give fails once the calling task doesn't hold the lock anymore
+    while (g_drawing_mutex && xSemaphoreGiveRecursive(g_drawing_mutex) == pdPASS)
+        depth++;
+
+    return depth;
+}
+
+void screen_lock_restore(uint8_t depth)
+{
+    while (depth--)
+        screen_lock();
+}
+
 void screen_set_hide_non_assigned_actuators(uint8_t hide)
 {
     g_hide_non_assigned_actuators = hide;
@@ -99,6 +320,27 @@ void screen_set_hide_non_assigned_actuators(uint8_t hide)
 void screen_clear(uint8_t display_id)
 {
     glcd_clear(hardware_glcds(display_id), GLCD_WHITE);
+    screen_invalidate(display_id);
+}
+
+void screen_invalidate(uint8_t display_id)
+{
+    uint8_t i;
+
+    for (i = 0; i < POTS_COUNT; i++)
+    {
+        if (((i < 4) ? DISPLAY_LEFT : DISPLAY_RIGHT) == display_id)
+            g_pot_cache[i].valid = 0;
+    }
+
+    for (i = 0; i < SCREEN_FOOTERS_COUNT; i++)
+    {
+        if (((i < 2) ? DISPLAY_LEFT : DISPLAY_RIGHT) == display_id)
+            g_footer_cache[i].valid = 0;
+    }
+
+    if (display_id < ENCODERS_COUNT)
+        g_encoder_cache[display_id].valid = 0;
 }
 
 void screen_pot(uint8_t pot_id, control_t *control)
@@ -113,6 +355,7 @@ void screen_pot(uint8_t pot_id, control_t *control)
     //the knob posistion is used to know if the knob is oriented to the left or right of the screen.
     //The left knobs clear one more pixel in the X posistion that does not get inverted, this is our white middle line in the display
     knob_t knob;
+    uint8_t clear_x = 0, clear_y = 0, clear_width = 0, clear_height = 0;
     switch(pot_id)
     {
         case 0:
@@ -120,28 +363,28 @@ void screen_pot(uint8_t pot_id, control_t *control)
             knob.x = 28;
             knob.y = 32;
             knob.orientation = 0;
-            glcd_rect_fill(display, 0, knob.y -7, 65, 16, GLCD_WHITE);
+            clear_x = 0; clear_y = knob.y -7; clear_width = 65; clear_height = 16;
             break;
         case 1:
         case 5:
             knob.x = 28;
             knob.y = 47;
             knob.orientation = 0;
-            glcd_rect_fill(display, 0, knob.y -6, 65, 14, GLCD_WHITE);
+            clear_x = 0; clear_y = knob.y -6; clear_width = 65; clear_height = 14;
             break;
         case 2:
         case 6:
             knob.x = 100;
             knob.y = 32;
             knob.orientation = 1;
-            glcd_rect_fill(display, 65, knob.y -7, 63, 16 , GLCD_WHITE);
+            clear_x = 65; clear_y = knob.y -7; clear_width = 63; clear_height = 16;
             break;
         case 3:
         case 7:
             knob.x = 100;
             knob.y = 47;
             knob.orientation = 1;
-            glcd_rect_fill(display, 65, knob.y -6, 63, 14 , GLCD_WHITE);
+            clear_x = 65; clear_y = knob.y -6; clear_width = 63; clear_height = 14;
             break;
         default:
             // not handled, trigger no assignment
@@ -149,6 +392,52 @@ void screen_pot(uint8_t pot_id, control_t *control)
             break;
     }
 
+    //what is going to be drawn, the formatting is done once here and reused by the drawing
+    widget_cache_t key;
+    char value_str_bfr[7] = {0};
+    cache_key_init(&key);
+
+    if (!control)
+    {
+        key.type = WIDGET_BLANK;
+    }
+    else if (control->properties & (FLAG_CONTROL_TOGGLED | FLAG_CONTROL_BYPASS))
+    {
+        key.type = WIDGET_TOGGLE;
+        cache_text(key.label, control->label, 7);
+        key.position = (control->properties & FLAG_CONTROL_TOGGLED)?control->value:!control->value;
+    }
+    else
+    {
+        pot_value_text(control, value_str_bfr);
+
+        knob.color = GLCD_BLACK;
+        knob.lock = control->scroll_dir;
+        knob.value = control->value;
+        knob.min = control->minimum;
+        knob.max = control->maximum;
+        knob.min_cal = g_pot_calibrations[0][pot_id];
+        knob.max_cal = g_pot_calibrations[1][pot_id];
+        if (control->properties & FLAG_CONTROL_LOGARITHMIC)
+        {
+            knob.mode = 1;
+        }
+        else knob.mode = 0;
+
+        key.type = WIDGET_KNOB;
+        cache_text(key.label, control->label, 7);
+        cache_text(key.value, value_str_bfr, sizeof(key.value) - 1);
+        cache_text(key.unit, control->unit, sizeof(key.unit) - 1);
+        key.position = widget_knob_position(&knob);
+    }
+
+    //nothing visible changed since the last time
+    if (pot_id < POTS_COUNT && widget_cached(&g_pot_cache[pot_id], &key))
+        return;
+
+    if (clear_width)
+        glcd_rect_fill(display, clear_x, clear_y, clear_width, clear_height, GLCD_WHITE);
+
     //no assignment
     if (!control)
     {
@@ -235,94 +524,6 @@ void screen_pot(uint8_t pot_id, control_t *control)
         strncpy(title_str_bfr, control->label, 7);
         title_str_bfr[7] = '\0';
 
-        //convert value
-        //value_str is our temporary value which we use for what kind of value representation we need
-        //value_str_bfr is the value that gets printed
-        char value_str[10] = {0};
-        char value_str_bfr[7] = {0};
-
-        if (!control->value_string) {
-            //if the value becomes bigger then 9999 (4 characters), then switch to another view 10999 becomes 10.9K
-            if (control->value > 9999) {
-                float_to_str((control->value/1000), value_str, sizeof(value_str), 1);
-                strcat(value_str, "K");
-            }
-            //else if we have a value bigger then 100, we dont display decimals anymore
-            else if (control->value > 99.9) {
-            	if (control->value > 999.9) {
-		  		int_to_str(control->value, value_str, sizeof(value_str), 0);
-            	}
-            	else {
-                    //not for ints or percantages
-                    if ((control->properties & FLAG_CONTROL_INTEGER) || (!strcmp(control->unit, "%"))) {
-                        int_to_str(control->value, value_str, sizeof(value_str), 0);
-                    }
-                    else {    
-                    	float_to_str((control->value), value_str, sizeof(value_str), 1);
-                    }
-            	}
-            }
-            //else if we have a value bigger then 10 we display just one decimal
-            else if (control->value > 9.9) {
-                //not for ints
-                if (control->properties & FLAG_CONTROL_INTEGER) {
-                    int_to_str(control->value, value_str, sizeof(value_str), 0);
-                }
-                else {
-                    float_to_str((control->value), value_str, sizeof(value_str), 6);
-                }
-            }
-            //if the value becomes less then 0 we change to 1 or 0 decimals
-            else if (control->value < 0) {
-                if (control->value > -99.9) {
-                    //not for ints
-                    if (control->properties & FLAG_CONTROL_INTEGER) {
-                        int_to_str(control->value, value_str, sizeof(value_str), 0);
-                    }
-                    else if (control->value < -9.9) {
-                        float_to_str((control->value), value_str, sizeof(value_str), 1);
-                    }
-                    else {
-                        float_to_str((control->value), value_str, sizeof(value_str), 2);
-                    }
-                }
-                else {
-                    if (control->value < -9999.9) {
-                        int_to_str(control->value/1000, value_str, sizeof(value_str), 0);
-                        strcat(value_str, "K");
-                    }
-                	int_to_str(control->value, value_str, sizeof(value_str), 0);
-                }
-            }
-            //for values between 0 and 10 display 2 decimals
-            else {
-                //not for ints
-                if (control->properties & FLAG_CONTROL_INTEGER) {
-                    int_to_str(control->value, value_str, sizeof(value_str), 0);
-                }
-                else {
-                    float_to_str((control->value), value_str, sizeof(value_str), 6);
-                }
-            }
-
-            //copy to value_str_bfr, the first 5 char
-            strncpy(value_str_bfr, value_str, 5);
-            //terminate the text with line ending, since no unit is added to it
-            value_str_bfr[5] = '\0';
-        }
-        else
-        {
-            //draw the value string
-            uint8_t char_cnt_value = strlen(control->value_string);
-
-            if (char_cnt_value > 5)
-                char_cnt_value = 5;
-
-            control->value_string[char_cnt_value] = '\0';
-            strcpy(value_str_bfr, control->value_string);
-            value_str_bfr[char_cnt_value] = '\0';
-        }
-
         //convert unit
         char *unit_str = 0;
         char tmp_unit[5];
@@ -340,18 +541,6 @@ void screen_pot(uint8_t pot_id, control_t *control)
         else unit_str = control->unit;   
 
         //knob
-        knob.color = GLCD_BLACK;
-        knob.lock = control->scroll_dir;
-        knob.value = control->value;
-        knob.min = control->minimum;
-        knob.max = control->maximum;
-        knob.min_cal = g_pot_calibrations[0][pot_id];
-        knob.max_cal = g_pot_calibrations[1][pot_id];
-        if (control->properties & FLAG_CONTROL_LOGARITHMIC)
-        {
-            knob.mode = 1;
-        }
-        else knob.mode = 0;
         widget_knob(display, &knob);
 
         //title:
@@ -500,6 +689,57 @@ static void null_screen_encoded(glcd_t *display, uint8_t display_id)
 void screen_encoder(uint8_t display_id, control_t *control)
 {
     glcd_t *display = hardware_glcds(display_id);
+
+    //what is going to be drawn, the formatting is done once here and reused by the drawing
+    widget_cache_t key;
+    char value_str_bfr[11] = {0};
+    cache_key_init(&key);
+
+    if (!control)
+    {
+        key.type = WIDGET_BLANK;
+    }
+    else if (control->properties & (FLAG_CONTROL_ENUMERATION | FLAG_CONTROL_SCALE_POINTS))
+    {
+        //the list shows the neighbour labels as well, it is always drawn
+        key.valid = 0;
+    }
+    else if (control->properties & (FLAG_CONTROL_TOGGLED | FLAG_CONTROL_BYPASS))
+    {
+        key.type = WIDGET_TOGGLE;
+        cache_text(key.label, control->label, sizeof(key.label) - 1);
+        key.position = (control->properties & FLAG_CONTROL_TOGGLED)?control->value:!control->value;
+    }
+    else if (control->properties & FLAG_CONTROL_INTEGER)
+    {
+        key.type = WIDGET_INTEGER;
+        cache_text(key.label, control->label, 14);
+        key.step = control->value;
+    }
+    else
+    {
+        encoder_value_text(control, value_str_bfr);
+
+        key.type = WIDGET_BAR;
+        cache_text(key.label, control->label, 24);
+        cache_text(key.value, value_str_bfr, sizeof(key.value) - 1);
+        if (!control->value_string)
+            cache_text(key.unit, control->unit, sizeof(key.unit) - 1);
+
+        if (control->screen_indicator_widget_val == -1) {
+            key.step = control->step;
+            key.steps = control->steps - 1;
+        }
+        else {
+            key.step = control->screen_indicator_widget_val * 100;
+            key.steps = 100;
+        }
+    }
+
+    //nothing visible changed since the last time
+    if (display_id < ENCODERS_COUNT && widget_cached(&g_encoder_cache[display_id], &key))
+        return;
+
     glcd_rect_fill(display, 0, 8, DISPLAY_WIDTH, 16, GLCD_WHITE);
 
     if (!control)
@@ -586,7 +826,7 @@ void screen_encoder(uint8_t display_id, control_t *control)
 
         textbox_t int_box;
         char *value_str = (char *) MALLOC(16 * sizeof(char));
-        char value_str_bfr[5] = {0};
+        char int_str_bfr[5] = {0};
         int_to_str(control->value, value_str, sizeof(value_str), 0);
         int_box.color = GLCD_BLACK;
         int_box.mode = TEXT_SINGLE_LINE;
@@ -597,12 +837,12 @@ void screen_encoder(uint8_t display_id, control_t *control)
         int_box.bottom_margin = 0;
         int_box.left_margin = 0;
         int_box.right_margin = 0;
-        strncpy(value_str_bfr, value_str, 4);
-        value_str_bfr[4] = '\0';
+        strncpy(int_str_bfr, value_str, 4);
+        int_str_bfr[4] = '\0';
         FREE(value_str);
-        int_box.text = value_str_bfr;
+        int_box.text = int_str_bfr;
         int_box.align = ALIGN_NONE_NONE;
-        int_box.x = (((DISPLAY_WIDTH / 4) + (DISPLAY_WIDTH / 2) )- (strlen(value_str_bfr) * 1.5));
+        int_box.x = (((DISPLAY_WIDTH / 4) + (DISPLAY_WIDTH / 2) )- (strlen(int_str_bfr) * 1.5));
         int_box.y = 13;
         widget_textbox(display, &int_box);
     }
@@ -616,49 +856,9 @@ void screen_encoder(uint8_t display_id, control_t *control)
         strncpy(title_str_bfr, control->label, 24);
         title_str_bfr[24] = '\0';
 
-        char value_str_bfr[11] = {0};
         char *unit_str_bfr = NULL;
 
         if (!control->value_string) {
-            //convert value
-            //value_str is our temporary value which we use for what kind of value representation we need
-            //value_str_bfr is the value that gets printed
-            char value_str[10] = {0};
-
-            //if the value becomes bigger then 9999 (4 characters), then switch to another view 10999 becomes 10.9K
-            if (control->value > 9999) {
-                int_to_str(control->value/1000, value_str, sizeof(value_str) - 1, 0);
-                strcat(value_str, "K");
-            }
-            //else if we have a value bigger then 100, we dont display decimals anymore
-            else if (control->value > 99.9) {
-                int_to_str(control->value, value_str, sizeof(value_str), 0);
-            }
-            //else if we have a value bigger then 10 we display just one decimal
-            else if (control->value > 9.9) {
-                float_to_str((control->value), value_str, sizeof(value_str), 1);
-            }
-            //if the value becomes less then 0 we change to 1 or 0 decimals
-            else if (control->value < 0) {
-                if (control->value > -99.9) {
-                    float_to_str(control->value, value_str, sizeof(value_str), 1);
-                }
-                else if (control->value < -9999.9) {
-                    int_to_str((control->value/1000), value_str, sizeof(value_str) - 1, 0);
-                    strcat(value_str, "K");
-                }
-                else int_to_str(control->value, value_str, sizeof(value_str), 0);
-            }
-            //for values between 0 and 10 display 2 decimals
-            else {
-                float_to_str(control->value, value_str, sizeof(value_str), 2);
-            }
-
-            //copy to value_str_bfr, the first 5 char
-            strncpy(value_str_bfr, value_str, 5);
-            //terminate the text with line ending
-            value_str_bfr[5] ='\0';
-
             //convert unit
             const char *unit_str;
             unit_str = (strcmp(control->unit, "") == 0 ? NULL : control->unit);
@@ -676,15 +876,6 @@ void screen_encoder(uint8_t display_id, control_t *control)
             }
         }
         else {
-            //draw the value string
-            uint8_t char_cnt_value = strlen(control->value_string);
-
-            if (char_cnt_value > 10)
-                char_cnt_value = 10;
-
-            control->value_string[char_cnt_value] = '\0';
-            strcpy(value_str_bfr, control->value_string);
-            value_str_bfr[char_cnt_value] = '\0';
             value.text = value_str_bfr;
         }
 
@@ -749,6 +940,28 @@ void screen_footer(uint8_t id, const char *name, const char *value, int16_t prop
     //we dont display foots when in fool mode
     if (naveg_is_tool_mode((id < 2)?DISPLAY_LEFT:DISPLAY_RIGHT)) return;
 
+    //nothing visible changed since the last time, at most 15 chars of the texts are displayed
+    if (id < SCREEN_FOOTERS_COUNT)
+    {
+        widget_cache_t key;
+        cache_key_init(&key);
+
+        if (name == NULL || value == NULL)
+        {
+            key.type = WIDGET_BLANK;
+        }
+        else
+        {
+            key.type = WIDGET_FOOTER;
+            key.property = property;
+            cache_text(key.label, name, 15);
+            cache_text(key.value, value, 15);
+        }
+
+        if (widget_cached(&g_footer_cache[id], &key))
+            return;
+    }
+
     uint8_t align = 0;
     switch (id)
     {
@@ -1027,6 +1240,8 @@ void screen_tool(uint8_t tool, uint8_t display_id)
     bp_list_t *bp_list;
     glcd_t *display = hardware_glcds(display_id);
 
+    screen_invalidate(display_id);
+
     switch (tool)
     {
         case DISPLAY_TOOL_SYSTEM:
@@ -1061,6 +1276,8 @@ void screen_bp_list(const char *title, bp_list_t *list)
     if (!naveg_is_tool_mode(DISPLAY_RIGHT))
         return; 
 
+    screen_invalidate(DISPLAY_RIGHT);
+
     listbox_t list_box;
     textbox_t title_box;
 
@@ -1135,6 +1352,9 @@ void screen_system_menu(menu_item_t *item)
 
     static menu_item_t *last_item = NULL;
 
+    screen_invalidate(DISPLAY_LEFT);
+    screen_invalidate(DISPLAY_RIGHT);
+
     glcd_t *display;
     if (item->desc->id == ROOT_ID)
     {
@@ -1280,7 +1500,10 @@ void screen_tuner(float frequency, char *note, int8_t cents)
 
     // checks if tuner is enable and update it
     if (naveg_is_tool_mode(DISPLAY_TOOL_TUNER))
+    {
         widget_tuner(hardware_glcds(1), &g_tuner);
+        screen_invalidate(DISPLAY_RIGHT);
+    }
 }
 
 void screen_tuner_input(uint8_t input)
@@ -1289,13 +1512,17 @@ void screen_tuner_input(uint8_t input)
 
     // checks if tuner is enable and update it
     if (naveg_is_tool_mode(DISPLAY_TOOL_TUNER))
+    {
         widget_tuner(hardware_glcds(1), &g_tuner);
+        screen_invalidate(DISPLAY_RIGHT);
+    }
 }
 
 void screen_image(uint8_t display, const uint8_t *image)
 {
     glcd_t *display_img = hardware_glcds(display);
     glcd_draw_image(display_img, 0, 0, image, GLCD_BLACK);
+    screen_invalidate(display);
 }
 
 void screen_master_vol(float volume_val)
@@ -1360,6 +1587,7 @@ void screen_master_vol(float volume_val)
 void screen_text_box(uint8_t display, uint8_t x, uint8_t y, const char *text)
 {
     glcd_t *hardware_display = hardware_glcds(display);
+    screen_invalidate(display);
 
     textbox_t text_box;
     text_box.color = GLCD_BLACK;
@@ -1381,6 +1609,7 @@ void screen_text_box(uint8_t display, uint8_t x, uint8_t y, const char *text)
 void screen_widget_overlay(uint8_t display, int8_t style, char *header, char *text)
 {
     glcd_t *hardware_display = hardware_glcds(display);
+    screen_invalidate(display);
 
     //clear encoder and pot  area
     glcd_rect_fill(hardware_display, 0, 9, 128, 46, GLCD_WHITE);
@@ -1438,7 +1667,4 @@ void screen_widget_overlay(uint8_t display, int8_t style, char *header, char *te
     if (style) {
         glcd_rect_invert(hardware_display, 2, 29, 124, 22);
     }
-
-    //update display
-    glcd_update(hardware_glcds(display));
 }
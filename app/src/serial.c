@@ -8,6 +8,13 @@
 #include "serial.h"
 #include "device.h"
 
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
 /*
 ************************************************************************************************************************
 *           LOCAL DEFINES
@@ -19,6 +26,9 @@
 #define UART2           ((LPC_UART_TypeDef *)LPC_UART2)
 #define UART3           ((LPC_UART_TypeDef *)LPC_UART3)
 
+// maximum transfer size of a GPDMA channel
+#define DMA_MAX_TRANSFER_SIZE   0xFFF
+
 
 /*
 ************************************************************************************************************************
@@ -33,6 +43,26 @@
 ************************************************************************************************************************
 */
 
+// in frame mode the received bytes are kept in the rx ring buffer until the frame is copied or released
+typedef struct FRAMES_T {
+    xQueueHandle queue;
+    uint8_t token;
+    // next byte to search for the token and the bytes of the current frame scanned so far
+    uint32_t scan, size;
+    // where the frame being written starts, a frame which doesn't fit is dropped from there
+    uint32_t start;
+    // dropping: the rest of a frame which didn't fit is discarded, resync: after an overrun
+    // the bytes up to the next token are a partial frame and are discarded
+    uint8_t dropping, resync;
+    // bumped whenever the rx buffer is dropped, the frames queued or read before are stale then
+    volatile uint16_t epoch;
+    uint16_t read_epoch;
+    // a frame is copied here when it wraps or when the DMA receives, in_place: the frame read is still
+    // on the rx buffer and is released by the task
+    uint8_t *linear;
+    uint8_t in_place;
+} frames_t;
+
 
 /*
 ************************************************************************************************************************
@@ -45,6 +75,28 @@
                              (port) == 2 ? UART2 : \
                              (port) == 3 ? UART3 : 0)
 
+#define GET_DMA_CONN(port)  ((port) == 0 ? GPDMA_CONN_UART0_Tx : \
+                             (port) == 1 ? GPDMA_CONN_UART1_Tx : \
+                             (port) == 2 ? GPDMA_CONN_UART2_Tx : \
+                             (port) == 3 ? GPDMA_CONN_UART3_Tx : 0)
+
+#define GET_DMA_RX_CONN(port)   ((port) == 0 ? GPDMA_CONN_UART0_Rx : \
+                                 (port) == 1 ? GPDMA_CONN_UART1_Rx : \
+                                 (port) == 2 ? GPDMA_CONN_UART2_Rx : \
+                                 (port) == 3 ? GPDMA_CONN_UART3_Rx : 0)
+
+#define GET_IRQ(port)       ((port) == 0 ? UART0_IRQn : \
+                             (port) == 1 ? UART1_IRQn : \
+                             (port) == 2 ? UART2_IRQn : \
+                             (port) == 3 ? UART3_IRQn : UART0_IRQn)
+
+#define GET_DMA_CHANNEL(ch) ((LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + ((ch) * 0x20)))
+
+// the frames queue entries carry the frame size and the epoch it was received in
+#define FRAME_ENTRY(size,epoch) ((size) | ((uint32_t) (epoch) << 16))
+#define FRAME_SIZE(entry)       ((entry) & 0xFFFF)
+#define FRAME_EPOCH(entry)      ((uint16_t) ((entry) >> 16))
+
 #ifdef OUTPUT_ENABLE_ACTIVE_IN_HIGH
 #define WRITE_MODE(s)   if (s->has_oe) {SET_PIN(s->oe_port, s->oe_pin); delay_us(OUTPUT_ENABLE_DELAY);}
 #define READ_MODE(s)    if (s->has_oe) CLR_PIN(s->oe_port, s->oe_pin);
@@ -62,6 +114,11 @@
 
 static serial_t *g_serial_instances[SERIAL_MAX_INSTANCES];
 static uint8_t g_init_instances = 0;
+static xSemaphoreHandle g_tx_sem[SERIAL_MAX_INSTANCES];
+static volatile uint8_t g_tx_waiting[SERIAL_MAX_INSTANCES];
+static uint8_t g_dma_init = 0;
+static GPDMA_LLI_Type g_rx_lli[SERIAL_MAX_INSTANCES][2];
+static frames_t g_frames[SERIAL_MAX_INSTANCES];
 
 
 /*
@@ -77,6 +134,29 @@ static uint8_t g_init_instances = 0;
 ************************************************************************************************************************
 */
 
+// the ring buffers are rounded up to a power of two, any other size would waste the rest of it
+#define NOT_POWER_OF_TWO(size)  ((size) & ((size) - 1))
+
+#if NOT_POWER_OF_TWO(SERIAL0_RX_BUFF_SIZE) || NOT_POWER_OF_TWO(SERIAL1_RX_BUFF_SIZE) || \
+    NOT_POWER_OF_TWO(SERIAL2_RX_BUFF_SIZE) || NOT_POWER_OF_TWO(SERIAL3_RX_BUFF_SIZE)
+#error "the serial rx buffer sizes must be a power of two"
+#endif
+
+// the rx buffer of a serial with rx DMA is filled in two halves, each one must fit a DMA transfer
+#define RX_DMA_OVERSIZED(channel,size)  ((channel) >= 0 && ((size) / 2) > DMA_MAX_TRANSFER_SIZE)
+
+#if RX_DMA_OVERSIZED(SERIAL0_RX_DMA_CHANNEL, SERIAL0_RX_BUFF_SIZE) || \
+    RX_DMA_OVERSIZED(SERIAL1_RX_DMA_CHANNEL, SERIAL1_RX_BUFF_SIZE) || \
+    RX_DMA_OVERSIZED(SERIAL2_RX_DMA_CHANNEL, SERIAL2_RX_BUFF_SIZE) || \
+    RX_DMA_OVERSIZED(SERIAL3_RX_DMA_CHANNEL, SERIAL3_RX_BUFF_SIZE)
+#error "the rx buffer of a serial with rx DMA can't be larger than two DMA transfers"
+#endif
+
+#if NOT_POWER_OF_TWO(SERIAL0_TX_BUFF_SIZE) || NOT_POWER_OF_TWO(SERIAL1_TX_BUFF_SIZE) || \
+    NOT_POWER_OF_TWO(SERIAL2_TX_BUFF_SIZE) || NOT_POWER_OF_TWO(SERIAL3_TX_BUFF_SIZE)
+#error "the serial tx buffer sizes must be a power of two"
+#endif
+
 
 /*
 ************************************************************************************************************************
@@ -84,10 +164,65 @@ static uint8_t g_init_instances = 0;
 ************************************************************************************************************************
 */
 
+static void frames_reset(serial_t *serial)
+{
+    frames_t *frames = &g_frames[serial->uart_id];
+
+    frames->scan = serial->rx_buffer->head;
+    frames->start = serial->rx_buffer->head;
+    frames->size = 0;
+    frames->dropping = 0;
+    frames->resync = 0;
+    frames->epoch++;
+}
+
+static void frames_scan(serial_t *serial)
+{
+    frames_t *frames = &g_frames[serial->uart_id];
+    ringbuff_t *rb = serial->rx_buffer;
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    if (!frames->queue) return;
+
+    // only the bytes received since the last scan are searched for the end of frame
+    while (frames->scan != rb->head)
+    {
+        uint32_t span = rb->size - frames->scan;
+        uint32_t used = (rb->head - frames->scan) & (rb->size - 1);
+        if (span > used) span = used;
+
+        uint8_t *data = &rb->buffer[frames->scan];
+        uint8_t *found = memchr(data, frames->token, span);
+        if (found) span = (found - data) + 1;
+
+        // if the queue is full the frame is left unscanned, it's queued once the task reads a frame
+        if (found && !frames->resync)
+        {
+            uint32_t entry = FRAME_ENTRY(frames->size + span, frames->epoch);
+            if (xQueueSendToBackFromISR(frames->queue, &entry, &xHigherPriorityTaskWoken) != pdTRUE)
+                break;
+        }
+
+        frames->scan = (frames->scan + span) & (rb->size - 1);
+        frames->size = found ? 0 : frames->size + span;
+
+        // no frame is waiting to be released during the resync, so the partial frame is released here
+        if (frames->resync)
+        {
+            ringbuff_read(rb, NULL, span);
+            if (found) frames->resync = 0;
+        }
+    }
+
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
 static void uart_receive(serial_t *serial)
 {
     LPC_UART_TypeDef *uart = GET_UART(serial->uart_id);
 
+    frames_t *frames = &g_frames[serial->uart_id];
+    ringbuff_t *rb = serial->rx_buffer;
     uint32_t count, written;
     uint8_t buffer[FIFO_TRIGGER];
 
@@ -95,18 +230,139 @@ static void uart_receive(serial_t *serial)
     // keeps one byte on FIFO to force CTI interrupt
     count = UART_Receive(uart, buffer, FIFO_TRIGGER-1, NONE_BLOCKING);
 
-    // writes data to ring buffer
-    written = ringbuff_write(serial->rx_buffer, buffer, count);
+    if (!frames->queue)
+    {
+        // writes data to ring buffer
+        written = ringbuff_write(rb, buffer, count);
+
+        // checks if all data fits on ring buffer
+        while (written < count)
+        {
+            // invokes callback because buffer is full
+            if (serial->rx_callback) serial->rx_callback(serial);
 
-    // checks if all data fits on ring buffer
+            // writes remaining data
+            written += ringbuff_write(rb, &buffer[written], (count - written));
+        }
+
+        return;
+    }
+
+    // in frame mode the data is only consumed by the task, a frame which doesn't fit is dropped as a whole,
+    // so the next frame doesn't pick up a truncated prefix
+    written = 0;
     while (written < count)
     {
-        // invokes callback because buffer is full
-        if (serial->rx_callback) serial->rx_callback(serial);
+        uint8_t *end = memchr(&buffer[written], frames->token, count - written);
+        uint32_t size = end ? (uint32_t) (end - &buffer[written]) + 1 : count - written;
+
+        if (!frames->dropping && ringbuff_write(rb, &buffer[written], size) < size)
+        {
+            uint32_t mask = rb->size - 1;
+
+            // the scan restarts from the start of the frame if it already went into it
+            if (((frames->scan - frames->start) & mask) <= ((rb->head - frames->start) & mask))
+            {
+                frames->scan = frames->start;
+                frames->size = 0;
+            }
+
+            ringbuff_publish(rb, frames->start);
+            frames->dropping = 1;
+        }
+
+        // the next frame starts after the token
+        if (end)
+        {
+            frames->start = rb->head;
+            frames->dropping = 0;
+        }
+
+        written += size;
+    }
 
-        // writes remaining data
-        written += ringbuff_write(serial->rx_buffer, &buffer[written], (count - written));
+    frames_scan(serial);
+}
+
+static void dma_receive_start(serial_t *serial)
+{
+    LPC_GPDMACH_TypeDef *channel = GET_DMA_CHANNEL(serial->rx_dma_channel);
+    GPDMA_LLI_Type *lli = g_rx_lli[serial->uart_id];
+    uint32_t half = serial->rx_buffer->size / 2;
+
+    GPDMA_ChannelCmd(serial->rx_dma_channel, DISABLE);
+    ringbuff_flush(serial->rx_buffer);
+    frames_reset(serial);
+
+    // the transfer size has only 12 bits, so each transfer fills half of the ring buffer
+    GPDMA_Channel_CFG_Type GPDMACfg;
+    GPDMACfg.ChannelNum = serial->rx_dma_channel;
+    GPDMACfg.TransferSize = half;
+    GPDMACfg.TransferWidth = 0;
+    GPDMACfg.SrcMemAddr = 0;
+    GPDMACfg.DstMemAddr = (uint32_t) serial->rx_buffer->buffer;
+    GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+    GPDMACfg.SrcConn = GET_DMA_RX_CONN(serial->uart_id);
+    GPDMACfg.DstConn = 0;
+    GPDMACfg.DMALLI = (uint32_t) &lli[1];
+
+    GPDMA_Setup(&GPDMACfg);
+
+    // no terminal count interrupt, the uart interrupt publishes what was received
+    channel->CControl &= ~GPDMA_DMACCxControl_I;
+
+    // the two linked list items point to each other, so the DMA keeps filling the ring buffer
+    lli[0].SrcAddr = channel->CSrcAddr;
+    lli[0].DstAddr = (uint32_t) serial->rx_buffer->buffer;
+    lli[0].NextLLI = (uint32_t) &lli[1];
+    lli[0].Control = channel->CControl;
+
+    lli[1].SrcAddr = channel->CSrcAddr;
+    lli[1].DstAddr = (uint32_t) &serial->rx_buffer->buffer[half];
+    lli[1].NextLLI = (uint32_t) &lli[0];
+    lli[1].Control = channel->CControl;
+
+    GPDMA_ChannelCmd(serial->rx_dma_channel, ENABLE);
+}
+
+// where the DMA is writing on the ring buffer and whether it went past the bytes not read yet
+static uint8_t dma_overrun(serial_t *serial, uint32_t *head)
+{
+    LPC_GPDMACH_TypeDef *channel = GET_DMA_CHANNEL(serial->rx_dma_channel);
+    ringbuff_t *rb = serial->rx_buffer;
+
+    *head = (channel->CDestAddr - (uint32_t) rb->buffer) & (rb->size - 1);
+    uint32_t received = (*head - rb->head) & (rb->size - 1);
+
+    return (received > (rb->size - 1) - ringbuffer_used_space(rb));
+}
+
+static void dma_receive(serial_t *serial)
+{
+    ringbuff_t *rb = serial->rx_buffer;
+    uint32_t head;
+
+    // the DMA writes straight into the ring buffer, only its write index needs to be updated
+    uint8_t overrun = dma_overrun(serial, &head);
+
+    // the DMA doesn't stop when the buffer is full, if it went past the frames not released yet they
+    // were overwritten, so everything is dropped and the frames restart after the next token
+    if (g_frames[serial->uart_id].queue && overrun)
+    {
+        ringbuff_publish(rb, head);
+        ringbuff_read(rb, NULL, ringbuffer_used_space(rb));
+        frames_reset(serial);
+        g_frames[serial->uart_id].resync = 1;
     }
+    else
+    {
+        ringbuff_publish(rb, head);
+    }
+
+    frames_scan(serial);
+
+    if (!ringbuff_is_empty(serial->rx_buffer) && serial->rx_callback)
+        serial->rx_callback(serial);
 }
 
 static void uart_transmit(serial_t *serial)
@@ -146,6 +402,68 @@ static void uart_transmit(serial_t *serial)
     }
 }
 
+static void dma_transmit(serial_t *serial)
+{
+    LPC_UART_TypeDef *uart = GET_UART(serial->uart_id);
+
+    // a span is still being transferred, the next one is started when it completes
+    if (serial->tx_dma_size > 0) return;
+
+    uint8_t *data;
+    uint32_t span = ringbuff_peek_span(serial->tx_buffer, &data);
+
+    if (span == 0)
+    {
+        if (!serial->sof)
+        {
+            while (UART_CheckBusy(uart) == SET);
+            READ_MODE(serial);
+            serial->sof = 1;
+        }
+
+        return;
+    }
+
+    // if is start of frame checks whether OE is necessary
+    if (serial->sof)
+    {
+        WRITE_MODE(serial);
+        serial->sof = 0;
+    }
+
+    if (span > DMA_MAX_TRANSFER_SIZE)
+        span = DMA_MAX_TRANSFER_SIZE;
+
+    // the bytes are kept in the ring buffer until the transfer completes
+    serial->tx_dma_size = span;
+
+    GPDMA_Channel_CFG_Type GPDMACfg;
+    GPDMACfg.ChannelNum = serial->tx_dma_channel;
+    GPDMACfg.TransferSize = span;
+    GPDMACfg.TransferWidth = 0;
+    GPDMACfg.SrcMemAddr = (uint32_t) data;
+    GPDMACfg.DstMemAddr = 0;
+    GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+    GPDMACfg.SrcConn = 0;
+    GPDMACfg.DstConn = GET_DMA_CONN(serial->uart_id);
+    GPDMACfg.DMALLI = 0;
+
+    GPDMA_Setup(&GPDMACfg);
+    GPDMA_ChannelCmd(serial->tx_dma_channel, ENABLE);
+}
+
+static void tx_space_freed(serial_t *serial)
+{
+    // wakes up the task waiting for room on the tx buffer
+    if (g_tx_waiting[serial->uart_id])
+    {
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        g_tx_waiting[serial->uart_id] = 0;
+        xSemaphoreGiveFromISR(g_tx_sem[serial->uart_id], &xHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
 static void uart_handler(serial_t *serial)
 {
     uint32_t intsrc, tmp, status;
@@ -182,8 +500,17 @@ static void uart_handler(serial_t *serial)
         }
     }
 
+    // the DMA drains the FIFO, any interrupt only publishes what it has received
+    if (serial->rx_dma_channel >= 0)
+    {
+        if (tmp != UART_IIR_INTID_THRE)
+        {
+            serial->eof = (tmp == UART_IIR_INTID_CTI);
+            dma_receive(serial);
+        }
+    }
     // Receive Data Available or Character time-out
-    if ((tmp == UART_IIR_INTID_RDA) || (tmp == UART_IIR_INTID_CTI))
+    else if ((tmp == UART_IIR_INTID_RDA) || (tmp == UART_IIR_INTID_CTI))
     {
         serial->eof = 0;
         uart_receive(serial);
@@ -198,11 +525,17 @@ static void uart_handler(serial_t *serial)
             }
         }
     }
+    // pended by the task when it freed room on a full frames queue
+    else if (g_frames[serial->uart_id].queue)
+    {
+        frames_scan(serial);
+    }
 
     // Transmit Holding Empty
     if (tmp == UART_IIR_INTID_THRE)
     {
         uart_transmit(serial);
+        tx_space_freed(serial);
     }
 }
 
@@ -299,12 +632,45 @@ void serial_init(serial_t *serial)
     UARTFIFOConfigStruct.FIFO_Level = UART_FIFO_TRGLEV3;
     #endif
 
+    // the uart requests the DMA transfers to fill the tx FIFO and to drain the rx FIFO
+    if (serial->tx_dma_channel >= 0 || serial->rx_dma_channel >= 0)
+    {
+        UARTFIFOConfigStruct.FIFO_DMAMode = ENABLE;
+
+        if (!g_dma_init)
+        {
+            GPDMA_Init();
+            NVIC_SetPriority(DMA_IRQn, SERIAL_DMA_PRIORITY);
+            NVIC_EnableIRQ(DMA_IRQn);
+            g_dma_init = 1;
+        }
+    }
+
     // Initialize FIFO for UART peripheral
     UART_FIFOConfig(uart, &UARTFIFOConfigStruct);
 
+    // selects how the tx buffer is moved to the uart
+    if (serial->tx_dma_channel >= 0)
+    {
+        serial->transmit = dma_transmit;
+    }
+    else
+    {
+        serial->transmit = uart_transmit;
+    }
+
+    serial->tx_dma_size = 0;
+
     // creates ring buffers
-    serial->rx_buffer = ringbuff_create(serial->rx_buffer_size + 1);
-    serial->tx_buffer = ringbuff_create(serial->tx_buffer_size + 1);
+    // the sizes are already powers of two, so they are not rounded up
+    serial->rx_buffer = ringbuff_create(serial->rx_buffer_size);
+    serial->tx_buffer = ringbuff_create(serial->tx_buffer_size);
+
+    // vSemaphoreCreateBinary is created as available, takes it so
+    // the first wait for room on the tx buffer really blocks
+    vSemaphoreCreateBinary(g_tx_sem[serial->uart_id]);
+    xSemaphoreTake(g_tx_sem[serial->uart_id], 0);
+    g_tx_waiting[serial->uart_id] = 0;
 
     // initializes struct vars
     serial->rx_callback = 0;
@@ -353,6 +719,11 @@ void serial_enable_interupt(serial_t *serial)
 
     ringbuff_flush(serial->rx_buffer);
     ringbuff_flush(serial->tx_buffer);
+    frames_reset(serial);
+
+    // the DMA restarts from the beginning of the flushed rx buffer
+    if (serial->rx_dma_channel >= 0)
+        dma_receive_start(serial);
 
     // Enable UART Transmit
     UART_TxCmd(uart, ENABLE);
@@ -401,6 +772,11 @@ void serial_change_interupt_priority(serial_t *serial)
 
     ringbuff_flush(serial->rx_buffer);
     ringbuff_flush(serial->tx_buffer);
+    frames_reset(serial);
+
+    // the DMA restarts from the beginning of the flushed rx buffer
+    if (serial->rx_dma_channel >= 0)
+        dma_receive_start(serial);
 
     // set priority
     NVIC_SetPriority(irq, serial->priority);
@@ -411,76 +787,90 @@ void serial_change_interupt_priority(serial_t *serial)
 
 uint32_t serial_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
+    return serial_send_timeout(uart_id, data, data_size, SERIAL_WAIT_FOREVER);
+}
+
+uint32_t serial_send_timeout(uint8_t uart_id, const uint8_t *data, uint32_t data_size, uint32_t timeout)
+{
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART transmit interrupts during this
-    // read so the UART transmit interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_THRE, DISABLE);
+    portTickType ticks = (timeout == SERIAL_WAIT_FOREVER) ? portMAX_DELAY : (timeout / portTICK_RATE_MS);
+    uint32_t index = 0;
+
+    while (1)
+    {
+        index += serial_try_send(uart_id, &data[index], data_size - index);
+        if (index == data_size || timeout == 0) break;
+
+        // no room left, blocks until the transmit interrupt frees some space
+        g_tx_waiting[uart_id] = 1;
+        if (ringbuff_is_full(serial->tx_buffer) && xSemaphoreTake(g_tx_sem[uart_id], ticks) != pdTRUE)
+        {
+            g_tx_waiting[uart_id] = 0;
+            index += serial_try_send(uart_id, &data[index], data_size - index);
+            break;
+        }
+    }
 
-    uint32_t written, to_write, index;
-    written = ringbuff_write(serial->tx_buffer, data, data_size);
-    to_write = data_size - written;
-    index = written;
+    return index;
+}
 
-    uart_transmit(serial);
+uint32_t serial_try_send(uint8_t uart_id, const uint8_t *data, uint32_t data_size)
+{
+    serial_t *serial = g_serial_instances[uart_id];
 
-    // waits until all data be sent
-    while (to_write > 0)
+    if (!serial) return 0;
+
+    // the ring buffer is safe with this task as producer and the transmit interrupt as consumer,
+    // the interrupt is only disabled by uart_transmit while it starts the transmission
+    uint32_t written = ringbuff_write(serial->tx_buffer, data, data_size);
+
+    // starts the transmission if it's idle, otherwise the transmit interrupt keeps draining the buffer
+    if (written > 0 && serial->sof)
     {
-        if (!ringbuff_is_full(serial->tx_buffer))
+        if (serial->tx_dma_channel >= 0)
+        {
+            // the DMA interrupt may be completing the last span meanwhile
+            taskENTER_CRITICAL();
+            serial->transmit(serial);
+            taskEXIT_CRITICAL();
+        }
+        else
         {
-            written = ringbuff_write(serial->tx_buffer, &data[index], to_write);
-            to_write -= written;
-            index += written;
+            serial->transmit(serial);
         }
     }
 
-    return data_size;
+    return written;
 }
 
 uint32_t serial_read(uint8_t uart_id, uint8_t *data, uint32_t data_size)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART receive interrupts during this
-    // read so the UART receive interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_RBR, DISABLE);
-
+    // no need to lock out the receive interrupt, the ring buffer
+    // is safe with it as producer and a single consumer
     uint32_t count;
     count = ringbuff_read(serial->rx_buffer, data, data_size);
 
-    // Re-enable UART interrupts
-    UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
-
     return count;
 }
 
 uint32_t serial_read_until(uint8_t uart_id, uint8_t *data, uint32_t data_size, uint8_t token)
 {
-    LPC_UART_TypeDef *uart = GET_UART(uart_id);
     serial_t *serial = g_serial_instances[uart_id];
 
     if (!serial) return 0;
 
-    // Temporarily lock out UART receive interrupts during this
-    // read so the UART receive interrupt won't cause problems
-    // with the index values
-    UART_IntConfig(uart, UART_INTCFG_RBR, DISABLE);
-
+    // no need to lock out the receive interrupt, the ring buffer
+    // is safe with it as producer and a single consumer
     uint32_t count;
     count = ringbuff_read_until(serial->rx_buffer, data, data_size, token);
 
-    // Re-enable UART interrupts
-    UART_IntConfig(uart, UART_INTCFG_RBR, ENABLE);
-
     return count;
 }
 
@@ -496,9 +886,190 @@ void serial_flush_tx_buffer(uint8_t uart_id)
 {
     serial_t *serial = g_serial_instances[uart_id];
 
+    if (serial->tx_dma_channel >= 0)
+    {
+        // the span in flight is dropped as well, its completion would release the bytes queued after the flush
+        taskENTER_CRITICAL();
+        GPDMA_ChannelCmd(serial->tx_dma_channel, DISABLE);
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, serial->tx_dma_channel);
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, serial->tx_dma_channel);
+        serial->tx_dma_size = 0;
+        ringbuff_flush(serial->tx_buffer);
+
+        // the buffer is empty, so this ends the frame which was being sent
+        serial->transmit(serial);
+        taskEXIT_CRITICAL();
+        return;
+    }
+
     ringbuff_flush(serial->tx_buffer);
 }
 
+uint8_t serial_set_frames(uint8_t uart_id, uint8_t token, uint32_t max_frames)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+    frames_t *frames = &g_frames[uart_id];
+
+    if (!serial) return 0;
+
+    // a frame which wraps around the ring buffer is copied to this buffer to be handed contiguous
+    uint8_t *linear = (uint8_t *) MALLOC(serial->rx_buffer->size);
+    xQueueHandle queue = xQueueCreate(max_frames, sizeof(uint32_t));
+
+    // checks memory allocation
+    if (!linear || !queue)
+    {
+        if (linear) FREE(linear);
+        if (queue) vQueueDelete(queue);
+        return 0;
+    }
+
+    frames->linear = linear;
+    frames->token = token;
+    frames_reset(serial);
+
+    // the receive interrupt works in frame mode from now on
+    frames->queue = queue;
+
+    return 1;
+}
+
+uint32_t serial_read_frame(uint8_t uart_id, uint8_t **frame)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+    frames_t *frames = &g_frames[uart_id];
+    uint32_t entry, size, span;
+    uint8_t *data;
+
+    if (!serial || !frames->queue) return 0;
+
+    if (xQueueReceive(frames->queue, &entry, portMAX_DELAY) != pdTRUE)
+        return 0;
+
+    // there is room on the queue now for the frames left unscanned while it was full
+    if (frames->scan != serial->rx_buffer->head)
+        NVIC_SetPendingIRQ(GET_IRQ(uart_id));
+
+    size = FRAME_SIZE(entry);
+    frames->read_epoch = FRAME_EPOCH(entry);
+
+    // the frame was dropped meanwhile
+    NVIC_DisableIRQ(GET_IRQ(uart_id));
+    if (frames->read_epoch != frames->epoch || size > ringbuffer_used_space(serial->rx_buffer))
+    {
+        NVIC_EnableIRQ(GET_IRQ(uart_id));
+        return 0;
+    }
+
+    span = ringbuff_peek_span(serial->rx_buffer, &data);
+    NVIC_EnableIRQ(GET_IRQ(uart_id));
+
+    // the uart interrupt never writes over the bytes not released, so the frame is parsed in place
+    frames->in_place = (serial->rx_dma_channel < 0 && span >= size);
+    if (frames->in_place)
+    {
+        *frame = data;
+        return size;
+    }
+
+    // the DMA doesn't stop at them and could write over the frame while it is parsed, before the
+    // overrun is seen, so the frame is copied and its space is released right away
+    if (span >= size)
+    {
+        memcpy(frames->linear, data, size);
+    }
+    else
+    {
+        memcpy(frames->linear, data, span);
+        memcpy(&frames->linear[span], serial->rx_buffer->buffer, size - span);
+    }
+    *frame = frames->linear;
+
+    // the copy is only good if the DMA didn't reach the frame while it was made
+    NVIC_DisableIRQ(GET_IRQ(uart_id));
+    uint32_t head;
+    uint8_t valid = frames->read_epoch == frames->epoch &&
+                    !(serial->rx_dma_channel >= 0 && dma_overrun(serial, &head));
+    if (valid) ringbuff_read(serial->rx_buffer, NULL, size);
+    NVIC_EnableIRQ(GET_IRQ(uart_id));
+
+    return valid ? size : 0;
+}
+
+void serial_release_frame(uint8_t uart_id, uint32_t size)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+    frames_t *frames = &g_frames[uart_id];
+
+    if (!serial) return;
+
+    // a copied frame was released when read, and if the rx buffer was dropped since the frame was
+    // read there is nothing left to release
+    NVIC_DisableIRQ(GET_IRQ(uart_id));
+    if (frames->in_place && frames->read_epoch == frames->epoch)
+        ringbuff_read(serial->rx_buffer, NULL, size);
+    frames->in_place = 0;
+    NVIC_EnableIRQ(GET_IRQ(uart_id));
+}
+
+void serial_flush_frames(uint8_t uart_id)
+{
+    serial_t *serial = g_serial_instances[uart_id];
+    frames_t *frames = &g_frames[uart_id];
+
+    if (!serial || !frames->queue) return;
+
+    NVIC_DisableIRQ(GET_IRQ(uart_id));
+
+    // drops everything received, the DMA keeps writing from where it is
+    xQueueReset(frames->queue);
+    ringbuff_read(serial->rx_buffer, NULL, ringbuffer_used_space(serial->rx_buffer));
+    frames_reset(serial);
+
+    NVIC_EnableIRQ(GET_IRQ(uart_id));
+}
+
+void serial_rx_dma_poll(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < SERIAL_MAX_INSTANCES; i++)
+    {
+        serial_t *serial = g_serial_instances[i];
+
+        if (!serial || serial->rx_dma_channel < 0) continue;
+
+        // the DMA may drain the last bytes of a message on character time-out without the uart
+        // interrupt being fired, in this case pends the uart interrupt so it publishes them
+        uint32_t head = GET_DMA_CHANNEL(serial->rx_dma_channel)->CDestAddr - (uint32_t) serial->rx_buffer->buffer;
+        if ((head & (serial->rx_buffer->size - 1)) != serial->rx_buffer->head)
+            NVIC_SetPendingIRQ(GET_IRQ(i));
+    }
+}
+
+void serial_dma_handler(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < SERIAL_MAX_INSTANCES; i++)
+    {
+        serial_t *serial = g_serial_instances[i];
+
+        if (!serial || serial->tx_dma_channel < 0) continue;
+        if (!GPDMA_IntGetStatus(GPDMA_STAT_INT, serial->tx_dma_channel)) continue;
+
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, serial->tx_dma_channel);
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, serial->tx_dma_channel);
+
+        // releases the transferred span and starts the next one
+        ringbuff_read(serial->tx_buffer, NULL, serial->tx_dma_size);
+        serial->tx_dma_size = 0;
+        dma_transmit(serial);
+
+        tx_space_freed(serial);
+    }
+}
+
 void UART0_IRQHandler(void)
 {
     uart_handler(g_serial_instances[0]);
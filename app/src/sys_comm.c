@@ -8,6 +8,7 @@
 #include <string.h>
 #include "config.h"
 #include "serial.h"
+#include "screen.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
@@ -20,7 +21,8 @@
 ************************************************************************************************************************
 */
 
-#define SYSTEM_MAX_SEM_COUNT   10
+// maximum amount of complete messages waiting to be parsed
+#define SYSTEM_MAX_FRAMES       16
 
 
 /*
@@ -53,8 +55,7 @@
 static  void (*g_system_response_cb)(void *data, menu_item_t *item) = NULL;
 static  menu_item_t *g_current_item;
 static volatile uint8_t  g_system_blocked;
-static volatile xSemaphoreHandle g_system_sem = NULL;
-static  ringbuff_t *g_system_rx_rb;
+static xSemaphoreHandle g_system_response_sem;
 
 
 /*
@@ -77,30 +78,6 @@ static  ringbuff_t *g_system_rx_rb;
 ************************************************************************************************************************
 */
 
-static void system_rx_cb(serial_t *serial)
-{
-    uint8_t buffer[SERIAL_MAX_RX_BUFF_SIZE] = {};
-    uint32_t size = serial_read(serial->uart_id, buffer, sizeof(buffer));
-    if (size > 0)
-    {
-        ringbuff_write(g_system_rx_rb, buffer, size);
-        // check end of message
-        uint32_t i;
-        for (i = 0; i < size; i++)
-        {
-            if (buffer[i] == 0)
-            {
-                portBASE_TYPE xHigherPriorityTaskWoken;
-                xHigherPriorityTaskWoken = pdFALSE;
-                xSemaphoreGiveFromISR(g_system_sem, &xHigherPriorityTaskWoken);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-                break;
-            }
-        }
-    }
-}
-
-
 /*
 ************************************************************************************************************************
 *           GLOBAL FUNCTIONS
@@ -109,10 +86,12 @@ static void system_rx_cb(serial_t *serial)
 
 void sys_comm_init(void)
 {
-    g_system_sem = xSemaphoreCreateCounting(SYSTEM_MAX_SEM_COUNT, 0);
-    g_system_rx_rb = ringbuff_create(SYSTEM_COMM_RX_BUFF_SIZE);
+    // the messages are parsed straight from the serial rx buffer
+    serial_set_frames(SYSTEM_SERIAL, 0, SYSTEM_MAX_FRAMES);
 
-    serial_set_callback(SYSTEM_SERIAL, system_rx_cb);
+    // given every time a response is received
+    vSemaphoreCreateBinary(g_system_response_sem);
+    xSemaphoreTake(g_system_response_sem, 0);
 }
 
 void sys_comm_send(const char *command, const char *arguments)
@@ -147,14 +126,14 @@ void sys_comm_send(const char *command, const char *arguments)
     serial_send(SYSTEM_SERIAL, (const uint8_t*)buffer, data_size+1);
 }
 
-ringbuff_t* sys_comm_read(void)
+uint32_t sys_comm_read(char **data)
 {
-    if (xSemaphoreTake(g_system_sem, portMAX_DELAY) == pdTRUE)
-    {
-        return g_system_rx_rb;
-    }
+    return serial_read_frame(SYSTEM_SERIAL, (uint8_t **) data);
+}
 
-    return NULL;
+void sys_comm_release(uint32_t data_size)
+{
+    serial_release_frame(SYSTEM_SERIAL, data_size);
 }
 
 void sys_comm_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item)
@@ -172,16 +151,23 @@ void sys_comm_response_cb(void *data)
     }
 
     g_system_blocked = 0;
+    xSemaphoreGive(g_system_response_sem);
 }
 
 void sys_comm_wait_response(void)
 {
+    // blocks instead of spinning so the lower priority tasks keep running,
+    // a response given before this wait started doesn't release it
     g_system_blocked = 1;
-    while (g_system_blocked);
+    // the response is parsed by the protocol task, which draws
+    uint8_t depth = screen_lock_release();
+    while (g_system_blocked)
+        xSemaphoreTake(g_system_response_sem, portMAX_DELAY);
+    screen_lock_restore(depth);
 }
 
 //clear the ringbuffer
 void sys_comm_clear(void)
 {
-    ringbuff_flush(g_system_rx_rb);
+    serial_flush_frames(SYSTEM_SERIAL);
 }
@@ -10,8 +10,10 @@
 #include "ui_comm.h"
 #include "config.h"
 #include "serial.h"
+#include "screen.h"
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /*
@@ -20,7 +22,10 @@
 ************************************************************************************************************************
 */
 
-#define WEBGUI_MAX_SEM_COUNT   5
+// maximum amount of complete messages waiting to be parsed
+#define WEBGUI_MAX_FRAMES       32
+
+#define PIPELINE_TIMEOUT        (WEBGUI_PIPELINE_TIMEOUT / portTICK_RATE_MS)
 
 
 /*
@@ -36,6 +41,12 @@
 ************************************************************************************************************************
 */
 
+typedef struct PIPELINE_REQ_T {
+    uint8_t in_use, tag;
+    void (*response_cb)(void *data, menu_item_t *item);
+    menu_item_t *item;
+} pipeline_req_t;
+
 
 /*
 ************************************************************************************************************************
@@ -53,8 +64,11 @@
 static  void (*g_webgui_response_cb)(void *data, menu_item_t *item) = NULL;
 static  menu_item_t *g_current_item;
 static volatile uint8_t  g_webgui_blocked;
-static volatile xSemaphoreHandle g_webgui_sem = NULL;
-static  ringbuff_t *g_webgui_rx_rb;
+static xSemaphoreHandle g_webgui_response_sem;
+static volatile uint8_t g_pipeline_window, g_pipeline_outstanding;
+static uint8_t g_pipeline_tag;
+static pipeline_req_t g_pipeline_reqs[WEBGUI_PIPELINE_MAX_WINDOW];
+static xSemaphoreHandle g_pipeline_sem;
 
 
 /*
@@ -77,29 +91,16 @@ static  ringbuff_t *g_webgui_rx_rb;
 ************************************************************************************************************************
 */
 
-static void webgui_rx_cb(serial_t *serial)
+// drops the requests in flight, their responses are not coming anymore
+static void pipeline_reset(void)
 {
-    uint8_t buffer[SERIAL_MAX_RX_BUFF_SIZE] = {};
-    uint32_t size = serial_read(serial->uart_id, buffer, sizeof(buffer));
-    if (size > 0)
-    {
-        ringbuff_write(g_webgui_rx_rb, buffer, size);
-        // check end of message
-        uint32_t i;
-        for (i = 0; i < size; i++)
-        {
-            if (buffer[i] == 0)
-            {
-                portBASE_TYPE xHigherPriorityTaskWoken;
-                xHigherPriorityTaskWoken = pdFALSE;
-                xSemaphoreGiveFromISR(g_webgui_sem, &xHigherPriorityTaskWoken);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-                break;
-            }
-        }
-    }
-}
+    taskENTER_CRITICAL();
+    memset(g_pipeline_reqs, 0, sizeof(g_pipeline_reqs));
+    g_pipeline_outstanding = 0;
+    taskEXIT_CRITICAL();
 
+    xSemaphoreGive(g_pipeline_sem);
+}
 
 /*
 ************************************************************************************************************************
@@ -109,10 +110,16 @@ static void webgui_rx_cb(serial_t *serial)
 
 void ui_comm_init(void)
 {
-    g_webgui_sem = xSemaphoreCreateCounting(WEBGUI_MAX_SEM_COUNT, 0);
-    g_webgui_rx_rb = ringbuff_create(WEBGUI_COMM_RX_BUFF_SIZE);
+    // the messages are parsed straight from the serial rx buffer
+    serial_set_frames(WEBGUI_SERIAL, 0, WEBGUI_MAX_FRAMES);
 
-    serial_set_callback(WEBGUI_SERIAL, webgui_rx_cb);
+    // given every time a response is received
+    vSemaphoreCreateBinary(g_webgui_response_sem);
+    xSemaphoreTake(g_webgui_response_sem, 0);
+
+    // given every time a slot of the pipeline window is freed
+    vSemaphoreCreateBinary(g_pipeline_sem);
+    xSemaphoreTake(g_pipeline_sem, 0);
 }
 
 void ui_comm_webgui_send(const char *data, uint32_t data_size)
@@ -120,14 +127,14 @@ void ui_comm_webgui_send(const char *data, uint32_t data_size)
     serial_send(WEBGUI_SERIAL, (const uint8_t*)data, data_size+1);
 }
 
-ringbuff_t* ui_comm_webgui_read(void)
+uint32_t ui_comm_webgui_read(char **data)
 {
-    if (xSemaphoreTake(g_webgui_sem, portMAX_DELAY) == pdTRUE)
-    {
-        return g_webgui_rx_rb;
-    }
+    return serial_read_frame(WEBGUI_SERIAL, (uint8_t **) data);
+}
 
-    return NULL;
+void ui_comm_webgui_release(uint32_t data_size)
+{
+    serial_release_frame(WEBGUI_SERIAL, data_size);
 }
 
 void ui_comm_webgui_set_response_cb(void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item)
@@ -145,18 +152,133 @@ void ui_comm_webgui_response_cb(void *data)
     }
 
     g_webgui_blocked = 0;
+    xSemaphoreGive(g_webgui_response_sem);
 }
 
 void ui_comm_webgui_wait_response(void)
 {
+    // blocks instead of spinning so the lower priority tasks keep running,
+    // a response given before this wait started doesn't release it
     g_webgui_blocked = 1;
-    while (g_webgui_blocked);
+    // the response is parsed by the protocol task, which draws
+    uint8_t depth = screen_lock_release();
+    while (g_webgui_blocked)
+        xSemaphoreTake(g_webgui_response_sem, portMAX_DELAY);
+    screen_lock_restore(depth);
+}
+
+uint8_t ui_comm_webgui_set_pipeline_window(uint8_t window)
+{
+    if (window > WEBGUI_PIPELINE_MAX_WINDOW)
+        window = WEBGUI_PIPELINE_MAX_WINDOW;
+
+    // any request still in flight is dropped, the peer renegotiated or went away
+    g_pipeline_window = window;
+    pipeline_reset();
+
+    return window;
+}
+
+uint8_t ui_comm_webgui_pipeline_enabled(void)
+{
+    return (g_pipeline_window > 0);
+}
+
+void ui_comm_webgui_send_tagged(char *data, uint32_t data_size, uint32_t buffer_size,
+                                void (*resp_cb)(void *data, menu_item_t *item), menu_item_t *item)
+{
+    uint8_t i, tag;
+
+    // waits for a free slot on the window, if no response arrives in time they were lost
+    if (g_pipeline_outstanding >= g_pipeline_window && g_pipeline_window > 0)
+    {
+        uint8_t depth = screen_lock_release();
+
+        while (g_pipeline_outstanding >= g_pipeline_window && g_pipeline_window > 0)
+        {
+            if (xSemaphoreTake(g_pipeline_sem, PIPELINE_TIMEOUT) != pdTRUE)
+                pipeline_reset();
+        }
+
+        screen_lock_restore(depth);
+    }
+
+    // the peer disabled the pipelined mode meanwhile or there is no room for the tag
+    if (g_pipeline_window == 0 || data_size + 5 > buffer_size)
+    {
+        ui_comm_webgui_send(data, data_size);
+        return;
+    }
+
+    // inserts the tag as last argument
+    taskENTER_CRITICAL();
+    tag = g_pipeline_tag++;
+    taskEXIT_CRITICAL();
+
+    data[data_size++] = ' ';
+    data_size += int_to_str(tag, &data[data_size], buffer_size - data_size, 0);
+
+    // the slot is only reserved once the message is tagged, so its response will free it
+    taskENTER_CRITICAL();
+    for (i = 0; i < WEBGUI_PIPELINE_MAX_WINDOW; i++)
+    {
+        if (!g_pipeline_reqs[i].in_use)
+        {
+            g_pipeline_reqs[i].in_use = 1;
+            g_pipeline_reqs[i].tag = tag;
+            g_pipeline_reqs[i].response_cb = resp_cb;
+            g_pipeline_reqs[i].item = item;
+            g_pipeline_outstanding++;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    ui_comm_webgui_send(data, data_size);
+}
+
+uint8_t ui_comm_webgui_link_idle(void)
+{
+    return (!g_webgui_blocked && g_pipeline_outstanding == 0);
+}
+
+void ui_comm_webgui_tagged_response_cb(uint8_t tag, void *data)
+{
+    uint8_t i;
+    void (*response_cb)(void *data, menu_item_t *item) = NULL;
+    menu_item_t *item = NULL;
+
+    taskENTER_CRITICAL();
+    for (i = 0; i < WEBGUI_PIPELINE_MAX_WINDOW; i++)
+    {
+        if (g_pipeline_reqs[i].in_use && g_pipeline_reqs[i].tag == tag)
+        {
+            response_cb = g_pipeline_reqs[i].response_cb;
+            item = g_pipeline_reqs[i].item;
+            g_pipeline_reqs[i].in_use = 0;
+            g_pipeline_outstanding--;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    // a response to a request which was already given up has no slot to free
+    if (i == WEBGUI_PIPELINE_MAX_WINDOW)
+        return;
+
+    xSemaphoreGive(g_pipeline_sem);
+
+    if (response_cb)
+        response_cb(data, item);
 }
 
 //clear the ringbuffer
 void ui_comm_webgui_clear(void)
 {
-    ringbuff_flush(g_webgui_rx_rb);
+    serial_flush_frames(WEBGUI_SERIAL);
+
+    // the responses of the requests in flight were flushed as well
+    pipeline_reset();
 }
 
 //clear the ringbuffer
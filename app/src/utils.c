@@ -42,9 +42,16 @@
 ************************************************************************************************************************
 */
 
-#define BUFFER_IS_FULL(rb)      (rb->tail == (rb->head + 1) % rb->size)
-#define BUFFER_IS_EMPTY(rb)     (rb->head == rb->tail)
-#define BUFFER_INC(rb,idx)      (rb->idx = (rb->idx + 1) % rb->size)
+// the ring buffer size is always a power of two, so the indexes wrap with a mask
+#define BUFFER_MASK(rb)         (rb->size - 1)
+#define BUFFER_USED(rb,h,t)     (((h) - (t)) & BUFFER_MASK(rb))
+#define BUFFER_FREE(rb,h,t)     (((t) - (h) - 1) & BUFFER_MASK(rb))
+
+// head is only written by the producer and tail only by the consumer, so one interrupt and one task can share
+// a ring buffer without masking interrupts: the index of the other side is loaded with acquire semantics,
+// before touching the data, and the own index is stored with release semantics, after the data is copied
+#define INDEX_LOAD(idx)         __atomic_load_n(&(idx), __ATOMIC_ACQUIRE)
+#define INDEX_STORE(idx,val)    __atomic_store_n(&(idx), (val), __ATOMIC_RELEASE)
 
 
 /*
@@ -92,27 +99,6 @@ static char* reverse(char* str, uint32_t str_len)
     return str;
 }
 
-static void parse_quote(char *str)
-{
-    char *pquote, *pstr = str;
-
-    while (*pstr)
-    {
-        if (*pstr == '"')
-        {
-            // shift the string to left
-            pquote = pstr;
-            while (*pquote)
-            {
-                *pquote = *(pquote+1);
-                pquote++;
-            }
-        }
-        else pstr++;
-    }
-}
-
-
 /*
 ************************************************************************************************************************
 *           GLOBAL FUNCTIONS
@@ -169,38 +155,59 @@ char** strarr_split(char *str, const char token)
     if (!list) return NULL;
 
     // fill the list pointers
-    pstr = str;
-    list[0] = pstr;
-    count = 0;
-    while (*pstr)
+    strarr_split_static(str, token, list, count + 1);
+
+    return list;
+}
+
+uint32_t strarr_split_static(char *str, const char token, char **list, uint32_t list_size)
+{
+    uint32_t count = 0;
+    char *pread, *pwrite;
+    uint8_t quote = 0;
+
+    if (!str || !list || list_size < 2)
     {
-        if (*pstr == token && quote == 0)
+        if (list && list_size > 0) list[0] = NULL;
+        return 0;
+    }
+
+    // the quotation marks are removed while the string is compacted in place,
+    // so the write pointer never goes ahead of the read pointer
+    pread = pwrite = str;
+    list[count++] = pwrite;
+
+    while (*pread)
+    {
+        if (*pread == token && quote == 0)
         {
-            *pstr = '\0';
-            list[++count] = pstr + 1;
+            *pwrite++ = '\0';
+            if (count < list_size - 1) list[count] = pwrite;
+            count++;
         }
 #ifdef ENABLE_QUOTATION_MARKS
-        if (*pstr == '"')
+        else if (*pread == '"')
         {
             if (quote == 0) quote = 1;
             else
             {
-                if (*(pstr+1) == '"') pstr++;
+                if (*(pread+1) == '"') pread++;
                 else quote = 0;
             }
         }
 #endif
-        pstr++;
-    }
+        else
+        {
+            *pwrite++ = *pread;
+        }
 
-    list[++count] = NULL;
+        pread++;
+    }
 
-#ifdef ENABLE_QUOTATION_MARKS
-    count = 0;
-    while (list[count]) parse_quote(list[count++]);
-#endif
+    *pwrite = '\0';
+    list[(count < list_size - 1) ? count : list_size - 1] = NULL;
 
-    return list;
+    return count;
 }
 
 
@@ -507,12 +514,16 @@ ringbuff_t *ringbuff_create(uint32_t buffer_size)
 {
     ringbuff_t *rb = (ringbuff_t *) MALLOC(sizeof(ringbuff_t));
 
+    // rounds the size up to the next power of two
+    uint32_t size = 2;
+    while (size < buffer_size) size <<= 1;
+
     if (rb)
     {
         rb->head = 0;
         rb->tail = 0;
-        rb->size = buffer_size;
-        rb->buffer = (uint8_t *) MALLOC(buffer_size);
+        rb->size = size;
+        rb->buffer = (uint8_t *) MALLOC(size);
 
         // checks memory allocation
         if (!rb->buffer)
@@ -538,90 +549,127 @@ void ringbuff_destroy(ringbuff_t *rb)
 
 uint32_t ringbuff_write(ringbuff_t *rb, const uint8_t *data, uint32_t data_size)
 {
-    uint32_t bytes = 0;
-    const uint8_t *pdata, dummy = 0;
+    uint32_t head = rb->head;
+    uint32_t tail = INDEX_LOAD(rb->tail);
+    uint32_t span;
 
-    pdata =  data ? data : &dummy;
-    while (data_size > 0 && !BUFFER_IS_FULL(rb))
-    {
-        rb->buffer[rb->head] = *pdata;
-        if (data) pdata++;
-        BUFFER_INC(rb, head);
+    if (data_size > BUFFER_FREE(rb, head, tail))
+        data_size = BUFFER_FREE(rb, head, tail);
+
+    // copies up to the end of the buffer and then the wrapped part
+    span = rb->size - head;
+    if (span > data_size) span = data_size;
 
-        data_size--;
-        bytes++;
+    if (data)
+    {
+        memcpy(&rb->buffer[head], data, span);
+        memcpy(rb->buffer, &data[span], data_size - span);
     }
+    else
+    {
+        memset(&rb->buffer[head], 0, span);
+        memset(rb->buffer, 0, data_size - span);
+    }
+
+    INDEX_STORE(rb->head, (head + data_size) & BUFFER_MASK(rb));
 
-    return bytes;
+    return data_size;
 }
 
 uint32_t ringbuff_read(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size)
 {
-    uint32_t bytes = 0;
-    uint8_t *data = buffer;
+    uint32_t head = INDEX_LOAD(rb->head);
+    uint32_t tail = rb->tail;
+    uint32_t span;
 
-    while (buffer_size > 0 && !BUFFER_IS_EMPTY(rb))
-    {
-        if (buffer)
-            *data++ = rb->buffer[rb->tail];
+    if (buffer_size > BUFFER_USED(rb, head, tail))
+        buffer_size = BUFFER_USED(rb, head, tail);
 
-        BUFFER_INC(rb, tail);
+    // copies up to the end of the buffer and then the wrapped part
+    if (buffer)
+    {
+        span = rb->size - tail;
+        if (span > buffer_size) span = buffer_size;
 
-        buffer_size--;
-        bytes++;
+        memcpy(buffer, &rb->buffer[tail], span);
+        memcpy(&buffer[span], rb->buffer, buffer_size - span);
     }
 
-    return bytes;
+    INDEX_STORE(rb->tail, (tail + buffer_size) & BUFFER_MASK(rb));
+
+    return buffer_size;
+}
+
+uint32_t ringbuff_peek_span(ringbuff_t *rb, uint8_t **data)
+{
+    uint32_t head = INDEX_LOAD(rb->head);
+    uint32_t tail = rb->tail;
+    uint32_t span = rb->size - tail;
+
+    if (span > BUFFER_USED(rb, head, tail))
+        span = BUFFER_USED(rb, head, tail);
+
+    *data = &rb->buffer[tail];
+
+    return span;
+}
+
+void ringbuff_publish(ringbuff_t *rb, uint32_t head)
+{
+    INDEX_STORE(rb->head, head & BUFFER_MASK(rb));
 }
 
 uint32_t ringbuff_read_until(ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size, uint8_t token)
 {
-    uint32_t bytes = 0;
-    uint8_t *data, dummy;
+    uint32_t tail = rb->tail;
+    uint32_t used = BUFFER_USED(rb, INDEX_LOAD(rb->head), tail);
+    uint32_t span, bytes;
+    const uint8_t *found;
 
-    data = buffer;
     if (!buffer)
-    {
-        data = &dummy;
         buffer_size = rb->size;
-    }
 
-    if (ringbuff_count(rb, token) > 0)
-    {
-        while (buffer_size > 0 && !BUFFER_IS_EMPTY(rb))
-        {
-            *data = rb->buffer[rb->tail];
-            BUFFER_INC(rb, tail);
+    // searches the token on the first span and then on the wrapped part
+    span = rb->size - tail;
+    if (span > used) span = used;
 
-            buffer_size--;
-            bytes++;
+    found = memchr(&rb->buffer[tail], token, span);
+    if (found)
+    {
+        bytes = (found - &rb->buffer[tail]) + 1;
+    }
+    else
+    {
+        found = memchr(rb->buffer, token, used - span);
+        if (!found) return 0;
 
-            if (*data == token) break;
-            if (buffer) data++;
-        }
+        bytes = span + (found - rb->buffer) + 1;
     }
 
-    return bytes;
+    if (bytes > buffer_size)
+        bytes = buffer_size;
+
+    return ringbuff_read(rb, buffer, bytes);
 }
 
 uint32_t ringbuffer_used_space(ringbuff_t *rb)
 {
-    return ((rb->head - rb->tail) % rb->size);
+    return BUFFER_USED(rb, INDEX_LOAD(rb->head), INDEX_LOAD(rb->tail));
 }
 
 uint32_t ringbuff_available_space(ringbuff_t *rb)
 {
-    return (rb->size - ((rb->head - rb->tail) % rb->size));
+    return (rb->size - ringbuffer_used_space(rb));
 }
 
 uint32_t ringbuff_is_full(ringbuff_t *rb)
 {
-    return BUFFER_IS_FULL(rb);
+    return (BUFFER_FREE(rb, INDEX_LOAD(rb->head), INDEX_LOAD(rb->tail)) == 0);
 }
 
 uint32_t ringbuff_is_empty(ringbuff_t *rb)
 {
-    return BUFFER_IS_EMPTY(rb);
+    return (INDEX_LOAD(rb->head) == INDEX_LOAD(rb->tail));
 }
 
 void ringbuff_flush(ringbuff_t *rb)
@@ -650,12 +698,12 @@ uint32_t ringbuff_count(ringbuff_t *rb, uint8_t byte)
     uint8_t data;
 
     tail = rb->tail;
-    head = rb->head;
+    head = INDEX_LOAD(rb->head);
 
     while (tail != head)
     {
         data = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & BUFFER_MASK(rb);
 
         if (data == byte) count++;
     }
@@ -669,12 +717,12 @@ void ringbuff_peek(ringbuff_t *rb, uint8_t *buffer, uint8_t peek_size)
     uint8_t *data = buffer;
 
     tail = rb->tail;
-    head = rb->head;
+    head = INDEX_LOAD(rb->head);
 
     while (peek_size > 0 && tail != head)
     {
         *data++ = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & BUFFER_MASK(rb);
         peek_size--;
     }
 }
@@ -685,7 +733,7 @@ int32_t ringbuff_search(ringbuff_t *rb, const uint8_t *to_search, uint32_t size)
     uint32_t count = 0;
 
     tail = rb->tail;
-    head = rb->head;
+    head = INDEX_LOAD(rb->head);
 
     if (!to_search) return -1;
 
@@ -698,7 +746,7 @@ int32_t ringbuff_search(ringbuff_t *rb, const uint8_t *to_search, uint32_t size)
         do
         {
             data = rb->buffer[tail];
-            tail = (tail + 1) % rb->size;
+            tail = (tail + 1) & BUFFER_MASK(rb);
             count++;
         } while (data != *s && tail != head);
 
@@ -710,7 +758,7 @@ int32_t ringbuff_search(ringbuff_t *rb, const uint8_t *to_search, uint32_t size)
         while (tail != head)
         {
             data = rb->buffer[tail];
-            tail = (tail + 1) % rb->size;
+            tail = (tail + 1) & BUFFER_MASK(rb);
 
             s++;
             if (data != *s)
@@ -744,7 +792,7 @@ int32_t ringbuff_search2(ringbuff_t *rb, const uint8_t *to_search, uint32_t size
     do
     {
         data = rb->buffer[tail];
-        tail = (tail + 1) % rb->size;
+        tail = (tail + 1) & BUFFER_MASK(rb);
 
         if (data == *s)
         {
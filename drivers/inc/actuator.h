@@ -26,7 +26,7 @@ typedef enum {
 
 // Actuators properties
 typedef enum {
-    BUTTON_HOLD_TIME, ENCODER_STEPS
+    BUTTON_HOLD_TIME, ENCODER_STEPS, POT_MIN_CUTOFF, POT_BETA
 } actuator_prop_t;
 
 // Events definition
@@ -79,23 +79,28 @@ typedef enum {
     actuator_type_t type;               \
     uint8_t status, control;            \
     uint8_t events_flags;               \
-    void (*event) (void *actuator);     \
-    uint8_t debounce;
+    void (*event) (void *actuator);
 
 typedef struct BUTTON_T {
     actuators_common_fields
 
     uint8_t port, pin;
-    uint16_t hold_time, hold_time_counter;
+    uint16_t hold_time;
 } button_t;
 
 typedef struct ENCODER_T {
     actuators_common_fields
 
     uint8_t port, pin, port_chA, pin_chA, port_chB, pin_chB;
-    uint16_t hold_time, hold_time_counter;
+    uint16_t hold_time;
     uint8_t steps, state;
     int8_t counter;
+    // detents accumulated since the application took them (positive is clockwise)
+    volatile int8_t delta;
+    // acceleration of the last detent, from the smoothed time between detents (in clocks, times 4)
+    uint8_t acceleration;
+    uint16_t detent_interval;
+    uint32_t last_detent;
 } encoder_t;
 
 typedef struct POT_T {
@@ -103,6 +108,12 @@ typedef struct POT_T {
 
     uint8_t port, pin, function, channel;
     uint16_t value;
+    // filter cutoff at rest (0.1Hz steps) and its increase with speed (0.001Hz per value/s steps)
+    uint8_t min_cutoff, beta;
+    uint32_t last_sample, filtered;
+    int32_t speed;
+    // set once the filter was seeded with the first reading
+    uint8_t filter_init;
 } pot_t;
 
 
@@ -144,7 +155,10 @@ void actuator_enable_event(void *actuator, uint8_t events_flags);
 void actuator_set_event(void *actuator, void (*event)(void *actuator));
 uint8_t actuator_get_status(void *actuator);
 void actuators_clock(void);
+// returns the acceleration of the last turned encoder
 uint8_t actuator_get_acceleration(void);
+// returns the detents accumulated by the encoder and clears them
+int8_t actuator_encoder_take_delta(void *actuator);
 uint16_t actuator_pot_value(uint8_t pot_id);
 
 /*
@@ -0,0 +1,102 @@
+/*
+ * Port wide debounce using vertical counters, every bit of a 32 bits port is debounced at once.
+ * It doesn't touch the hardware, the caller feeds the active pins of a port once per clock.
+ */
+
+#ifndef  DEBOUNCE_H
+#define  DEBOUNCE_H
+
+
+/*
+*********************************************************************************************************
+*   INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include <stdint.h>
+
+
+/*
+*********************************************************************************************************
+*   DO NOT CHANGE THESE DEFINES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   CONFIGURATION DEFINES
+*********************************************************************************************************
+*/
+
+// Counters width, the debounce times go up to 127 clocks and the hold times up to 8191 clocks
+#define DEBOUNCE_COUNTER_BITS       7
+#define DEBOUNCE_HOLD_BITS          13
+
+
+/*
+*********************************************************************************************************
+*   DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef struct DEBOUNCE_T {
+    // bits being debounced and their debounced state (1 is active)
+    uint32_t mask, state;
+
+    // edges of the last clock
+    uint32_t pressed, released, held;
+
+    // bits counting towards a state change and bits counting towards a hold
+    uint32_t bouncing, armed;
+
+    // bit planes of the counters, plane 0 is the least significant bit of every counter
+    uint32_t counter[DEBOUNCE_COUNTER_BITS];
+    uint32_t press_time[DEBOUNCE_COUNTER_BITS], release_time[DEBOUNCE_COUNTER_BITS];
+    uint32_t hold_counter[DEBOUNCE_HOLD_BITS], hold_time[DEBOUNCE_HOLD_BITS];
+} debounce_t;
+
+
+/*
+*********************************************************************************************************
+*   GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   MACRO'S
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void debounce_init(debounce_t *db);
+// adds a bit, the times are the clocks the bit has to stay in the new state before it changes
+void debounce_add(debounce_t *db, uint8_t bit, uint16_t press_time, uint16_t release_time);
+// clocks a bit has to stay active before the held edge, zero disables it
+void debounce_set_hold(debounce_t *db, uint8_t bit, uint16_t hold_time);
+// debounces the active bits of the port and updates the edges
+void debounce_clock(debounce_t *db, uint32_t active);
+
+
+/*
+*********************************************************************************************************
+*   CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   END HEADER
+*********************************************************************************************************
+*/
+
+#endif
@@ -92,6 +92,7 @@
 #define glcd_rect_invert    FUNC_WRAP(rect_invert)
 #define glcd_draw_image     FUNC_WRAP(draw_image)
 #define glcd_text           FUNC_WRAP(text)
+#define glcd_present        FUNC_WRAP(present)
 #define glcd_update         FUNC_WRAP(update)
 
 
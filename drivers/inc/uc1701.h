@@ -45,8 +45,7 @@
 
 // display status
 #define NEED_UPDATE     1
-#define UPDATING        2
-#define FORCE_REFRESH   4
+#define NEED_CONFIG     2
 
 
 /*
@@ -88,7 +87,17 @@ typedef struct UC1701_T {
     uint8_t backlight_port, backlight_pin;
 
     uint8_t status;
+    uint8_t custom_pm, custom_rr;
+
+    // the drawing functions write on the buffer, the present copies its changed
+    // spans into the frame and the update sends the changed spans of the frame
     uint8_t buffer[DISPLAY_HEIGHT/8][DISPLAY_WIDTH];
+    uint8_t frame[DISPLAY_HEIGHT/8][DISPLAY_WIDTH];
+
+    // changed columns span of each page of the buffer, the page is clean when first > last
+    uint8_t dirty_first[DISPLAY_HEIGHT/8], dirty_last[DISPLAY_HEIGHT/8];
+    // columns span of each page of the frame not sent yet
+    uint8_t send_first[DISPLAY_HEIGHT/8], send_last[DISPLAY_HEIGHT/8];
 } uc1701_t;
 
 
@@ -115,6 +124,8 @@ typedef struct UC1701_T {
 void uc1701_init(uc1701_t *disp);
 void uc1701_backlight(uc1701_t *disp, uint8_t state);
 void uc1701_clear(uc1701_t *disp, uint8_t color);
+// the present must be called when the buffer holds a whole screen, the update only sends what was presented
+void uc1701_present(uc1701_t *disp);
 void uc1701_update(uc1701_t *disp);
 void uc1701_set_pixel(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t color);
 void uc1701_hline(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t color);
@@ -127,6 +138,11 @@ void uc1701_draw_image(uc1701_t *disp, uint8_t x, uint8_t y, const uint8_t *imag
 void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const uint8_t *font, uint8_t color);
 
 void uc1701_set_custom_value(uc1701_t *disp, uint8_t custom_pm, uint8_t custom_rr);
+
+// this function will be called when the buffer of an up to date display is changed
+// or when a new configuration must be applied by the update
+// the user must create this function in your application code
+extern void uc1701_update_request(uc1701_t *disp);
 /*
 ************************************************************************************************************************
 *           CONFIGURATION ERRORS
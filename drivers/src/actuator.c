@@ -10,9 +10,13 @@
 */
 
 #include "actuator.h"
+#include "debounce.h"
 
 #include "hardware.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 /*
 *********************************************************************************************************
 *   LOCAL DEFINES
@@ -38,6 +42,20 @@
 #define ENCODER_INIT_FLAG   0x04
 #define CLICK_CANCEL_FLAG   0x10
 
+#define GPIO_PORTS          6
+
+// the pot filter coefficient is alpha = w / (1 + w), with w = 2 * pi * cutoff * CLOCK_PERIOD
+// w is kept in Q16, the min cutoff scale is 2 * pi * 0.1Hz * 1ms * 2^16, the beta scale is
+// 2 * pi * 0.001Hz * 1ms * 2^16 * 1000 (the beta is per value/s, the speed is taken per ms),
+// both are scaled by the clock period
+#define POT_CUTOFF_SCALE    (41 * CLOCK_PERIOD)
+#define POT_BETA_SCALE      (412 * CLOCK_PERIOD)
+#define POT_SPEED_MAX       0x7FFF
+// fraction bits of the filtered pot value
+#define POT_FILTER_BITS     8
+// fraction bits of the pot speed
+#define POT_SPEED_BITS      4
+
 
 /*
 *********************************************************************************************************
@@ -45,6 +63,16 @@
 *********************************************************************************************************
 */
 
+// quadrature steps indexed by the previous (bits 0-1) and the current (bits 2-3) A/B pins
+// encoder algorithm from PaulStoffregen
+// https://github.com/PaulStoffregen/Encoder
+static const int8_t ENCODER_STEPS_TABLE[16] = {
+    0, -1, 1, -2,
+    1, 0, 2, -1,
+    -1, 2, 0, 1,
+    -2, 1, -1, 0
+};
+
 
 /*
 *********************************************************************************************************
@@ -73,9 +101,17 @@
 static void *g_actuators_pointers[MAX_ACTUATORS];
 static uint8_t g_actuators_count = 0;
 
-static uint8_t acceleration = 1;
+static encoder_t *g_last_encoder;
 static uint16_t g_pot_value[POTS_COUNT] = {};
 
+// ports read once per clock, for the buttons and for the encoders channels
+static uint8_t g_read_ports;
+
+// buttons and encoder buttons are debounced per port, each bit maps back to its actuator
+static debounce_t g_debounce[GPIO_PORTS];
+static uint32_t g_active_low[GPIO_PORTS];
+static uint8_t g_debounce_actuator[GPIO_PORTS][32];
+
 /*
 *********************************************************************************************************
 *   LOCAL FUNCTION PROTOTYPES
@@ -98,6 +134,97 @@ static void event(void *actuator, uint8_t flags);
 *********************************************************************************************************
 */
 
+static void debounce_register(void *actuator, uint8_t port, uint8_t pin,
+                              uint16_t press_time, uint16_t release_time, uint8_t activated)
+{
+    uint8_t i;
+
+    for (i = 0; i < g_actuators_count; i++)
+    {
+        if (g_actuators_pointers[i] == actuator) g_debounce_actuator[port][pin] = i;
+    }
+
+    g_read_ports |= (1UL << port);
+
+    if (activated) g_active_low[port] &= ~(1UL << pin);
+    else g_active_low[port] |= (1UL << pin);
+
+    debounce_add(&g_debounce[port], pin, press_time / CLOCK_PERIOD, release_time / CLOCK_PERIOD);
+    debounce_set_hold(&g_debounce[port], pin, ((button_t *) actuator)->hold_time / CLOCK_PERIOD);
+}
+
+// new acceleration from the time since the previous detent
+static void encoder_accelerate(encoder_t *encoder)
+{
+    uint32_t now = hardware_timestamp();
+    uint32_t interval = now - encoder->last_detent;
+    encoder->last_detent = now;
+
+    // a pause restarts the acceleration, otherwise the interval is smoothed with 1/4 of the new one,
+    // the smoothed interval is kept times 4 so it settles on exactly the new one
+    if (interval >= ENCODER_ACCEL_WINDOW)
+        encoder->detent_interval = ENCODER_ACCEL_WINDOW * 4;
+    else
+        encoder->detent_interval += interval - (encoder->detent_interval / 4);
+
+    // x detents within the window is a detent every window / x clocks
+    if (encoder->detent_interval < (ENCODER_ACCEL_WINDOW * 4 / ENCODER_ACCEL_STEP_3))
+        encoder->acceleration = 7;
+    else if (encoder->detent_interval < (ENCODER_ACCEL_WINDOW * 4 / ENCODER_ACCEL_STEP_2))
+        encoder->acceleration = 5;
+    else if (encoder->detent_interval < (ENCODER_ACCEL_WINDOW * 4 / ENCODER_ACCEL_STEP_1))
+        encoder->acceleration = 3;
+    else
+        encoder->acceleration = 1;
+}
+
+// buttons and encoders share the status and control fields
+static void button_edges(void *actuator, uint32_t bit, const debounce_t *db)
+{
+    button_t *button = (button_t *) actuator;
+
+    // button pressed
+    if (db->pressed & bit)
+    {
+        SET_FLAG(button->control, BUTTON_ON_FLAG);
+
+        // update status flags
+        CLR_FLAG(button->status, EV_BUTTON_RELEASED);
+        SET_FLAG(button->status, EV_BUTTON_PRESSED);
+
+        event(button, EV_BUTTON_PRESSED);
+    }
+
+    // button hold
+    if (db->held & bit)
+    {
+        SET_FLAG(button->status, EV_BUTTON_HELD);
+        SET_FLAG(button->control, CLICK_CANCEL_FLAG);
+
+        event(button, EV_BUTTON_HELD);
+    }
+
+    // button released
+    if (db->released & bit)
+    {
+        CLR_FLAG(button->control, BUTTON_ON_FLAG);
+
+        // update status flags
+        CLR_FLAG(button->status, EV_BUTTON_PRESSED);
+        SET_FLAG(button->status, EV_BUTTON_RELEASED);
+
+        // check if must set click flag
+        if (!(button->control & CLICK_CANCEL_FLAG))
+        {
+            SET_FLAG(button->status, EV_BUTTON_CLICKED);
+        }
+
+        CLR_FLAG(button->control, CLICK_CANCEL_FLAG);
+
+        event(button, EV_BUTTON_RELEASED | EV_BUTTON_CLICKED);
+    }
+}
+
 static void event(void *actuator, uint8_t flags)
 {
     button_t *button = (button_t *) actuator;
@@ -159,8 +286,6 @@ void actuator_create(actuator_type_t type, uint8_t id, void *actuator)
             button->event = 0;
             button->events_flags = 0;
             button->hold_time = 0;
-            button->hold_time_counter = 0;
-            button->debounce = 0;
             button->control = 0;
             button->status = 0;
             break;
@@ -171,12 +296,14 @@ void actuator_create(actuator_type_t type, uint8_t id, void *actuator)
             encoder->event = 0;
             encoder->events_flags = 0;
             encoder->hold_time = 0;
-            encoder->hold_time_counter = 0;
-            encoder->debounce = 0;
             encoder->control = 0;
             encoder->status = 0;
             encoder->steps = 0;
             encoder->counter = 0;
+            encoder->delta = 0;
+            encoder->acceleration = 1;
+            encoder->detent_interval = ENCODER_ACCEL_WINDOW * 4;
+            encoder->last_detent = 0;
             break;
 
         case POT:
@@ -184,10 +311,15 @@ void actuator_create(actuator_type_t type, uint8_t id, void *actuator)
             pot->type = type;
             pot->event = 0;
             pot->events_flags = 0;
-            pot->debounce = 0;
             pot->control = 0;
             pot->status = 0;
             pot->value = 0;
+            pot->min_cutoff = 0;
+            pot->beta = 0;
+            pot->last_sample = 0;
+            pot->filtered = 0;
+            pot->speed = 0;
+            pot->filter_init = 0;
             break;
     }
 
@@ -209,18 +341,23 @@ void actuator_set_pins(void *actuator, const uint8_t *pins)
             button->port = pins[0];
             button->pin = pins[1];
             CONFIG_PIN_INPUT(button->port, button->pin);
+            debounce_register(button, button->port, button->pin,
+                              BUTTON_PRESS_DEBOUNCE, BUTTON_RELEASE_DEBOUNCE, BUTTON_ACTIVATED);
             break;
 
         case ROTARY_ENCODER:
             button->port = pins[0];
             button->pin = pins[1];
             CONFIG_PIN_INPUT(button->port, button->pin);
+            debounce_register(encoder, encoder->port, encoder->pin,
+                              ENCODER_PRESS_DEBOUNCE, ENCODER_RELEASE_DEBOUNCE, ENCODER_ACTIVATED);
             encoder->port_chA = pins[2];
             encoder->pin_chA = pins[3];
             encoder->port_chB = pins[4];
             encoder->pin_chB = pins[5];
             CONFIG_PIN_INPUT(encoder->port_chA, encoder->pin_chA);
             CONFIG_PIN_INPUT(encoder->port_chB, encoder->pin_chB);
+            g_read_ports |= (1UL << encoder->port_chA) | (1UL << encoder->port_chB);
             break;
 
         case POT:
@@ -238,6 +375,7 @@ void actuator_set_prop(void *actuator, actuator_prop_t prop, uint16_t value)
 {
     button_t *button = (button_t *) actuator;
     encoder_t *encoder = (encoder_t *) actuator;
+    pot_t *pot = (pot_t *) actuator;
 
     switch (ACTUATOR_TYPE(actuator))
     {
@@ -245,7 +383,8 @@ void actuator_set_prop(void *actuator, actuator_prop_t prop, uint16_t value)
             if (prop == BUTTON_HOLD_TIME)
             {
                 button->hold_time = value;
-                button->hold_time_counter = value / CLOCK_PERIOD;
+                if (g_debounce[button->port].mask & (1UL << button->pin))
+                    debounce_set_hold(&g_debounce[button->port], button->pin, value / CLOCK_PERIOD);
             }
             break;
 
@@ -253,7 +392,8 @@ void actuator_set_prop(void *actuator, actuator_prop_t prop, uint16_t value)
             if (prop == BUTTON_HOLD_TIME)
             {
                 encoder->hold_time = value;
-                encoder->hold_time_counter = value / CLOCK_PERIOD;
+                if (g_debounce[encoder->port].mask & (1UL << encoder->pin))
+                    debounce_set_hold(&g_debounce[encoder->port], encoder->pin, value / CLOCK_PERIOD);
             }
             else if (prop == ENCODER_STEPS)
             {
@@ -262,6 +402,14 @@ void actuator_set_prop(void *actuator, actuator_prop_t prop, uint16_t value)
             break;
 
         case POT:
+            if (prop == POT_MIN_CUTOFF)
+            {
+                pot->min_cutoff = value;
+            }
+            else if (prop == POT_BETA)
+            {
+                pot->beta = value;
+            }
             break;
     }
 }
@@ -335,7 +483,22 @@ uint8_t actuator_get_status(void *actuator)
 
 uint8_t actuator_get_acceleration(void)
 {
-    return acceleration;
+    return g_last_encoder ? g_last_encoder->acceleration : 1;
+}
+
+int8_t actuator_encoder_take_delta(void *actuator)
+{
+    encoder_t *encoder = (encoder_t *) actuator;
+    int8_t delta;
+
+    if (ACTUATOR_TYPE(actuator) != ROTARY_ENCODER) return 0;
+
+    taskENTER_CRITICAL();
+    delta = encoder->delta;
+    encoder->delta = 0;
+    taskEXIT_CRITICAL();
+
+    return delta;
 }
 
 uint16_t actuator_pot_value(uint8_t pot_id)
@@ -345,281 +508,83 @@ uint16_t actuator_pot_value(uint8_t pot_id)
 
 void actuators_clock(void)
 {
-    button_t *button;
     encoder_t *encoder;
     pot_t *pot;
-    uint8_t i, button_on = 0;
+    uint8_t i, port;
+
+    //the DMA interrupt keeps the sums of the last conversions of each ADC channel
+    const volatile uint32_t *pot_sums = hardware_pots_sums();
+
+    //each port is read once, then all of its button bits are debounced at once
+    uint32_t pins[GPIO_PORTS];
+    for (port = 0; port < GPIO_PORTS; port++)
+    {
+        debounce_t *db = &g_debounce[port];
+        if (!(g_read_ports & (1UL << port))) continue;
+
+        pins[port] = READ_PINS(port);
+        if (!db->mask) continue;
 
-    //this is our weighing factor for smoothing the pot value's
-    static float k = 0.01;
-    static uint16_t current_value[POTS_COUNT] = {};
+        debounce_clock(db, pins[port] ^ g_active_low[port]);
+
+        //only the bits with an edge go back to their actuators
+        uint32_t edges = db->pressed | db->released | db->held;
+        while (edges)
+        {
+            uint8_t bit = __builtin_ctz(edges);
+            edges &= edges - 1;
+
+            button_edges(g_actuators_pointers[g_debounce_actuator[port][bit]], (1UL << bit), db);
+        }
+    }
 
     for (i = 0; i < g_actuators_count; i++)
     {
         switch (ACTUATOR_TYPE(g_actuators_pointers[i]))
         {
             case BUTTON:
-                button = (button_t *) g_actuators_pointers[i];
-
-                if (READ_PIN(button->port, button->pin) == BUTTON_ACTIVATED)
-                    button_on = BUTTON_ON_FLAG;
-                else
-                    button_on = 0;
-
-                // button on same state
-                if (button_on == (button->control & BUTTON_ON_FLAG))
-                {
-                    // button pressed
-                    if (button_on)
-                    {
-                        // reset debounce counter
-                        button->debounce =  BUTTON_RELEASE_DEBOUNCE / CLOCK_PERIOD;
-
-                        // button hold
-                        if (button->hold_time_counter > 0)
-                        {
-                            button->hold_time_counter--;
-                            if (button->hold_time_counter == 0)
-                            {
-                                SET_FLAG(button->status, EV_BUTTON_HELD);
-                                SET_FLAG(button->control, CLICK_CANCEL_FLAG);
-
-                                event(button, EV_BUTTON_HELD);
-                            }
-                        }
-                    }
-                    // button released
-                    else
-                    {
-                        // reset debounce counter
-                        button->debounce = BUTTON_PRESS_DEBOUNCE / CLOCK_PERIOD;
-
-                        // reload hold time counter
-                        button->hold_time_counter = button->hold_time / CLOCK_PERIOD;
-                    }
-                }
-                // button state change
-                else
-                {
-                    button->debounce--;
-                    if (button->debounce == 0) // debounce OK
-                    {
-                        // update control flags
-                        CLR_FLAG(button->control, BUTTON_ON_FLAG);
-                        button->control |= button_on;
-
-                        // button pressed
-                        if (button_on)
-                        {
-                            // update status flags
-                            CLR_FLAG(button->status, EV_BUTTON_RELEASED);
-                            SET_FLAG(button->status, EV_BUTTON_PRESSED);
-
-                            event(button, EV_BUTTON_PRESSED);
-
-                            // reload debounce counter
-                            button->debounce = BUTTON_RELEASE_DEBOUNCE / CLOCK_PERIOD;
-                        }
-                        // button released
-                        else
-                        {
-                            // update status flags
-                            CLR_FLAG(button->status, EV_BUTTON_PRESSED);
-                            SET_FLAG(button->status, EV_BUTTON_RELEASED);
-
-                            // check if must set click flag
-                            if (!(button->control & CLICK_CANCEL_FLAG))
-                            {
-                                SET_FLAG(button->status, EV_BUTTON_CLICKED);
-                            }
-
-                            CLR_FLAG(button->control, CLICK_CANCEL_FLAG);
-
-                            event(button, EV_BUTTON_RELEASED | EV_BUTTON_CLICKED);
-
-                            // reload debounce counter
-                            button->debounce = BUTTON_PRESS_DEBOUNCE / CLOCK_PERIOD;
-                        }
-                    }
-                }
+                // debounced with the ports above
                 break;
 
             case ROTARY_ENCODER:
                 encoder = (encoder_t *) g_actuators_pointers[i];
 
-                // --- button processing ---
-
-                // read button pin
-                if (READ_PIN(encoder->port, encoder->pin) == ENCODER_ACTIVATED)
-                    button_on = BUTTON_ON_FLAG;
-                else
-                    button_on = 0;
-
-                // button on same state
-                //cheating a bit here with &&!encoder->id this removes the hold state from the second encoder
-                if (button_on == (encoder->control & BUTTON_ON_FLAG))
-                {
-                    // button pressed
-                    if (button_on)
-                    {
-                        // reset debounce counter
-                        encoder->debounce =  ENCODER_RELEASE_DEBOUNCE / CLOCK_PERIOD;
-
-                        // button hold
-                        if (encoder->hold_time_counter > 0)
-                        {
-                            encoder->hold_time_counter--;
-
-                            if (encoder->hold_time_counter == 0)
-                            {
-                                SET_FLAG(encoder->status, EV_BUTTON_HELD);
-                                SET_FLAG(encoder->control, CLICK_CANCEL_FLAG);
-
-                                event(encoder, EV_BUTTON_HELD);
-                            }
-                        }
-                    }
-                    // button released
-                    else
-                    {
-                        // reset debounce counter
-                        encoder->debounce = ENCODER_PRESS_DEBOUNCE / CLOCK_PERIOD;
-
-                        // reload hold time counter
-                        encoder->hold_time_counter = encoder->hold_time / CLOCK_PERIOD;
-                    }
-                }
-                // button state change
-                else
-                {
-                    encoder->debounce--;
-                    if (encoder->debounce == 0) // debounce OK
-                    {
-                        // update control flags
-                        CLR_FLAG(encoder->control, BUTTON_ON_FLAG);
-                        encoder->control |= button_on;
-
-                        // button pressed
-                        if (button_on)
-                        {
-                            // update status flags
-                            CLR_FLAG(encoder->status, EV_BUTTON_RELEASED);
-                            SET_FLAG(encoder->status, EV_BUTTON_PRESSED);
-
-                            event(encoder, EV_BUTTON_PRESSED);
-
-                            // reload debounce counter
-                            encoder->debounce = ENCODER_RELEASE_DEBOUNCE / CLOCK_PERIOD;
-                        }
-                        // button released
-                        else
-                        {
-                            // update status flags
-                            CLR_FLAG(encoder->status, EV_BUTTON_PRESSED);
-                            SET_FLAG(encoder->status, EV_BUTTON_RELEASED);
-
-                            // check if must set click flag
-                            if (!(encoder->control & CLICK_CANCEL_FLAG))
-                            {
-                                SET_FLAG(encoder->status, EV_BUTTON_CLICKED);
-                            }
-
-                            CLR_FLAG(encoder->control, CLICK_CANCEL_FLAG);
-
-                            event(encoder, EV_BUTTON_RELEASED | EV_BUTTON_CLICKED);
-
-                            // reload debounce counter
-                            encoder->debounce = ENCODER_PRESS_DEBOUNCE / CLOCK_PERIOD;
-                        }
-                    }
-                }
-
                 // --- rotary processing ---
-                // encoder algorithm from PaulStoffregen
-                // https://github.com/PaulStoffregen/Encoder
-                static uint8_t acceleration_count = 0;
-                static uint8_t firsttick = 0;
-
                 uint8_t seq = encoder->state & 3;
 
-                seq |= READ_PIN(encoder->port_chA, encoder->pin_chA) ? 4 : 0;
-                seq |= READ_PIN(encoder->port_chB, encoder->pin_chB) ? 8 : 0;
+                seq |= ((pins[encoder->port_chA] >> encoder->pin_chA) & 1) ? 4 : 0;
+                seq |= ((pins[encoder->port_chB] >> encoder->pin_chB) & 1) ? 8 : 0;
+                encoder->state = (seq >> 2);
 
-                switch (seq)
-                {
-                    // these ones are sent quite often during normal operation
-                    case 0: case 5: case 10: case 15:
-                        break;
-
-                    // 1 step up
-                    case 1: case 7: case 8: case 14:
-                        if (encoder->counter > 0) // this fixes inverting direction
-                            encoder->counter = 0;
-                        encoder->counter--;
-                        break;
-
-                    // 1 step down
-                    case 2: case 4: case 11: case 13:
-                        if (encoder->counter < 0) // this fixes inverting direction
-                            encoder->counter = 0;
-                        encoder->counter++;
-                        break;
-
-                    // 2 steps up
-                    case 3: case 12:
-                        encoder->counter -= 2;
-                        break;
-
-                    // 2 steps down
-                    case 6: case 9:
-                        encoder->counter += 2;
-                        break;
-
-                    // default should never trigger (because math)
-                    default:
-                        continue;
-                }
+                int8_t step = ENCODER_STEPS_TABLE[seq];
+                if (step == 0) break;
 
-                 encoder->state = (seq >> 2);
-
-                 if (firsttick)
-                     acceleration_count++;
+                // the steps back are kept, so a bouncing channel cancels itself and a turn back within a
+                // detent returns to it instead of shifting the next detents
+                encoder->counter += step;
 
                 // checks the steps
                 if (ABS(encoder->counter) >= encoder->steps)
                 {
-                    static uint8_t ticks_count = 0;
-                    firsttick = 1;
-                    if (acceleration_count < 100)
-                    {
-                        ticks_count++;
-                        if (ticks_count > ENCODER_ACCEL_STEP_3)
-                            acceleration = 7;
-                        else if (ticks_count > ENCODER_ACCEL_STEP_2)
-                            acceleration = 5;
-                        else if (ticks_count > ENCODER_ACCEL_STEP_1)
-                            acceleration = 3;
-                        else
-                            acceleration = 1;
-                    }
-                    else
-                    {
-                        acceleration_count = 0;
-                        firsttick = 0;
-                        ticks_count = 0;
-                        acceleration = 1;
-                    }
+                    encoder_accelerate(encoder);
+                    g_last_encoder = encoder;
 
                     // update flags
                     CLR_FLAG(encoder->status, EV_ENCODER_TURNED_CW);
                     CLR_FLAG(encoder->status, EV_ENCODER_TURNED_ACW);
                     SET_FLAG(encoder->status, EV_ENCODER_TURNED);
 
-                    // set the direction flag
+                    // set the direction flag and accumulates the detent until the application takes it
                     if (encoder->counter > 0)
+                    {
                         SET_FLAG(encoder->status, EV_ENCODER_TURNED_CW);
+                        if (encoder->delta < INT8_MAX) encoder->delta++;
+                    }
                     else
+                    {
                         SET_FLAG(encoder->status, EV_ENCODER_TURNED_ACW);
+                        if (encoder->delta > INT8_MIN) encoder->delta--;
+                    }
 
                     event(encoder, EV_ENCODER_TURNED | EV_ENCODER_TURNED_CW | EV_ENCODER_TURNED_ACW);
 
@@ -633,16 +598,40 @@ void actuators_clock(void)
                 //clear the pot event
                 CLR_FLAG(pot->status, EV_POT_TURNED);
 
-                //if channel bussy we skip an actuator clock cycle, TODO make me not so dirty 
-                if (ADC_ChannelGetStatus(LPC_ADC, pot->channel, 1))
+                //the pot is only used once its sum holds a complete set of its conversions
+                uint32_t pot_sum = pot_sums[pot->channel];
+                if (pot_sum & HARDWARE_POT_SUM_VALID)
                 {
-                    uint16_t tmp = (((*(uint16_t *)((&LPC_ADC->DR[0]) + pot->channel)>>4)&0xFFF));
+                    uint32_t tmp = pot_sum & ~HARDWARE_POT_SUM_VALID;
+
+                    //first reading, start the filter from it
+                    if (!pot->filter_init)
+                    {
+                        pot->filter_init = 1;
+                        pot->filtered = tmp << POT_FILTER_BITS;
+                        pot->last_sample = tmp;
+                    }
+
+                    //smoothed derivative, speed += delta - speed / 2^shift, the noise cancels itself before the abs,
+                    //the fraction bits keep the shift from leaving the speed anywhere within a step of the delta
+                    pot->speed += ((int32_t)(tmp - pot->last_sample) << POT_SPEED_BITS) - (pot->speed >> POT_SPEED_SHIFT);
+                    pot->last_sample = tmp;
+
+                    uint32_t speed = ABS(pot->speed) >> POT_SPEED_BITS;
+                    if (speed > POT_SPEED_MAX) speed = POT_SPEED_MAX;
+
+                    //the cutoff rises with the speed, so slow moves are smooth and fast moves don't lag
+                    uint32_t w = (pot->min_cutoff * POT_CUTOFF_SCALE) +
+                        ((pot->beta * (speed / CLOCK_PERIOD) * POT_BETA_SCALE) >> (POT_SPEED_SHIFT + POT_OVERSAMPLING_SHIFT));
+                    uint32_t alpha = 0x10000 - (0xFFFFFFFF / (w + 0x10000));
 
-                    //apply weighing factor
-                    current_value[pot->id] = k * tmp + (1.0 - k) * current_value[pot->id];
+                    //filtered += (tmp - filtered) * alpha
+                    int32_t error = (int32_t)((tmp << POT_FILTER_BITS) - pot->filtered);
+                    pot->filtered += (int32_t)(((int64_t) error * alpha) >> 16);
 
-                    //set a tmp val
-                    uint16_t val = current_value[pot->id];
+                    //round back to the 12 bits of the ADC
+                    uint16_t val = (pot->filtered + (1 << (POT_FILTER_BITS + POT_OVERSAMPLING_SHIFT - 1))) >>
+                        (POT_FILTER_BITS + POT_OVERSAMPLING_SHIFT);
 
                     //if turned and difference is suficiant
                     if ((val > pot->value) ? ((val - pot->value) > POT_THRESHOLD) : ((pot->value - val) > POT_THRESHOLD))
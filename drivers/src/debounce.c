@@ -0,0 +1,224 @@
+
+/*
+ * Note: the counters of all bits are stored as bit planes (vertical counters), so each plane
+ * operation moves the counters of the whole port at once
+ */
+
+/*
+*********************************************************************************************************
+*   INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include "debounce.h"
+
+
+/*
+*********************************************************************************************************
+*   LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL MACROS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL CONFIGURATION ERRORS
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*   LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// writes the value of one counter into the planes
+static void vertical_set(uint32_t *planes, uint8_t planes_count, uint8_t bit, uint16_t value)
+{
+    uint8_t i;
+
+    for (i = 0; i < planes_count; i++)
+    {
+        if (value & (1 << i)) planes[i] |= (1UL << bit);
+        else planes[i] &= ~(1UL << bit);
+    }
+}
+
+// decrements the counters of the bits in mask, returns the ones which reached zero
+static uint32_t vertical_decrement(uint32_t *planes, uint8_t planes_count, uint32_t mask)
+{
+    uint32_t borrow = mask, not_zero = 0;
+    uint8_t i;
+
+    for (i = 0; i < planes_count; i++)
+    {
+        uint32_t plane = planes[i];
+        planes[i] = plane ^ borrow;
+        borrow &= ~plane;
+        not_zero |= planes[i];
+    }
+
+    return mask & ~not_zero;
+}
+
+// loads the counters of the bits in mask from the source planes
+static void vertical_load(uint32_t *planes, const uint32_t *source, uint8_t planes_count, uint32_t mask)
+{
+    uint8_t i;
+
+    for (i = 0; i < planes_count; i++)
+    {
+        planes[i] = (planes[i] & ~mask) | (source[i] & mask);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*   GLOBAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+void debounce_init(debounce_t *db)
+{
+    uint8_t i;
+
+    db->mask = 0;
+    db->state = 0;
+    db->pressed = 0;
+    db->released = 0;
+    db->held = 0;
+    db->bouncing = 0;
+    db->armed = 0;
+
+    for (i = 0; i < DEBOUNCE_COUNTER_BITS; i++)
+    {
+        db->counter[i] = 0;
+        db->press_time[i] = 0;
+        db->release_time[i] = 0;
+    }
+
+    for (i = 0; i < DEBOUNCE_HOLD_BITS; i++)
+    {
+        db->hold_counter[i] = 0;
+        db->hold_time[i] = 0;
+    }
+}
+
+void debounce_add(debounce_t *db, uint8_t bit, uint16_t press_time, uint16_t release_time)
+{
+    const uint16_t max_time = (1 << DEBOUNCE_COUNTER_BITS) - 1;
+
+    // a zero time would wrap the counter on the first decrement
+    if (press_time == 0) press_time = 1;
+    if (release_time == 0) release_time = 1;
+    if (press_time > max_time) press_time = max_time;
+    if (release_time > max_time) release_time = max_time;
+
+    vertical_set(db->press_time, DEBOUNCE_COUNTER_BITS, bit, press_time);
+    vertical_set(db->release_time, DEBOUNCE_COUNTER_BITS, bit, release_time);
+
+    // starts released
+    db->mask |= (1UL << bit);
+    db->state &= ~(1UL << bit);
+    db->bouncing &= ~(1UL << bit);
+    db->armed &= ~(1UL << bit);
+    vertical_set(db->counter, DEBOUNCE_COUNTER_BITS, bit, press_time);
+}
+
+void debounce_set_hold(debounce_t *db, uint8_t bit, uint16_t hold_time)
+{
+    const uint16_t max_time = (1 << DEBOUNCE_HOLD_BITS) - 1;
+
+    if (hold_time > max_time) hold_time = max_time;
+
+    vertical_set(db->hold_time, DEBOUNCE_HOLD_BITS, bit, hold_time);
+}
+
+void debounce_clock(debounce_t *db, uint32_t active)
+{
+    uint32_t diff = (active ^ db->state) & db->mask;
+    uint32_t toggled = 0;
+    uint8_t i;
+
+    db->pressed = 0;
+    db->released = 0;
+    db->held = 0;
+
+    // nothing changing and nothing bouncing, the counters already hold their reload values
+    if (diff | db->bouncing)
+    {
+        // the bits out of their state count down, they change state when the counter reaches zero
+        toggled = vertical_decrement(db->counter, DEBOUNCE_COUNTER_BITS, diff);
+        db->state ^= toggled;
+
+        // bits which bounced back or just changed state restart from the time of their state
+        uint32_t reload = (db->bouncing & ~diff) | toggled;
+        if (reload)
+        {
+            for (i = 0; i < DEBOUNCE_COUNTER_BITS; i++)
+            {
+                uint32_t time = (db->state & db->release_time[i]) | (~db->state & db->press_time[i]);
+                db->counter[i] = (db->counter[i] & ~reload) | (time & reload);
+            }
+        }
+
+        db->bouncing = diff & ~toggled;
+        db->pressed = toggled & db->state;
+        db->released = toggled & ~db->state;
+    }
+
+    // released bits stop counting the hold, the held ones count down while they stay active
+    db->armed &= ~db->released;
+    if (db->armed & ~diff)
+    {
+        db->held = vertical_decrement(db->hold_counter, DEBOUNCE_HOLD_BITS, db->armed & ~diff);
+        db->armed &= ~db->held;
+    }
+
+    // pressed bits start counting the hold, unless they have no hold time
+    if (db->pressed)
+    {
+        uint32_t has_hold = 0;
+        for (i = 0; i < DEBOUNCE_HOLD_BITS; i++) has_hold |= db->hold_time[i];
+
+        vertical_load(db->hold_counter, db->hold_time, DEBOUNCE_HOLD_BITS, db->pressed);
+        db->armed |= db->pressed & has_hold;
+    }
+}
@@ -18,6 +18,8 @@
 
 #include "task.h"
 
+#include <string.h>
+
 
 /*
 ************************************************************************************************************************
@@ -25,6 +27,10 @@
 ************************************************************************************************************************
 */
 
+// glyph index of the proportional fonts
+#define GLYPH_INDEX_FONTS       4
+#define GLYPH_INDEX_CHARS       128
+
 
 /*
 ************************************************************************************************************************
@@ -39,6 +45,16 @@
 ************************************************************************************************************************
 */
 
+typedef struct GLYPH_INDEX_T {
+    const uint8_t *font;
+    uint16_t offset[GLYPH_INDEX_CHARS];
+} glyph_index_t;
+
+// changed columns span of each page gathered by a drawing function, merged into the display at once
+typedef struct DIRTY_T {
+    uint8_t first[DISPLAY_HEIGHT/8], last[DISPLAY_HEIGHT/8];
+} dirty_t;
+
 
 /*
 ************************************************************************************************************************
@@ -48,18 +64,18 @@
 
 // buffer manipulation macros
 #define READ_BUFFER(disp,x,y)           disp->buffer[(y)/8][(DISPLAY_WIDTH-1)-(x)]
-#define WRITE_BUFFER(disp,x,y,data)     disp->buffer[(y)/8][(DISPLAY_WIDTH-1)-(x)] = (data); \
-                                        disp->status |= NEED_UPDATE; \
-                                        if (disp->status & UPDATING) disp->status |= FORCE_REFRESH;
+#define WRITE_BUFFER(disp,dirty,x,y,data)   disp->buffer[(y)/8][(DISPLAY_WIDTH-1)-(x)] = (data); \
+                                            dirty_mark(dirty, (y)/8, (DISPLAY_WIDTH-1)-(x), (DISPLAY_WIDTH-1)-(x));
 
 // general purpose macros
 #define ABS_DIFF(a, b)                  ((a > b) ? (a - b) : (b - a))
 #define SWAP(a, b)                      do{uint8_t t; t = a; a = b; b = t;} while(0)
 
 // SSP macros
-#define SEND_DATA(disp, data)           taskENTER_CRITICAL(); SSP_SendData(disp->ssp_module, data); taskEXIT_CRITICAL();\
-                                        while (SSP_GetStatus(disp->ssp_module, SSP_STAT_TXFIFO_EMPTY) == RESET || \
+#define WAIT_SEND_DONE(disp)            while (SSP_GetStatus(disp->ssp_module, SSP_STAT_TXFIFO_EMPTY) == RESET || \
                                                SSP_GetStatus(disp->ssp_module, SSP_STAT_BUSY) == SET);
+#define SEND_DATA(disp, data)           taskENTER_CRITICAL(); SSP_SendData(disp->ssp_module, data); taskEXIT_CRITICAL();\
+                                        WAIT_SEND_DONE(disp)
 
 // backlight macros
 #if defined UC1701_BACKLIGHT_TURN_ON_WITH_ONE
@@ -77,6 +93,9 @@
 ************************************************************************************************************************
 */
 
+// built the first time each proportional font is drawn
+static glyph_index_t g_glyph_index[GLYPH_INDEX_FONTS];
+
 
 /*
 ************************************************************************************************************************
@@ -98,6 +117,87 @@
 ************************************************************************************************************************
 */
 
+static inline void dirty_init(dirty_t *dirty)
+{
+    memset(dirty->first, DISPLAY_WIDTH, sizeof(dirty->first));
+    memset(dirty->last, 0, sizeof(dirty->last));
+}
+
+// marks the columns span of the page as changed
+static inline void dirty_mark(dirty_t *dirty, uint8_t page, uint8_t first, uint8_t last)
+{
+    if (first < dirty->first[page]) dirty->first[page] = first;
+    if (last > dirty->last[page]) dirty->last[page] = last;
+}
+
+// merges the changed spans into the display, the application is only notified when the display was up to date
+static void need_update(uc1701_t *disp, const dirty_t *dirty)
+{
+    uint8_t page, notify, changed = 0;
+
+    // the update takes the dirty spans in a critical section as well, so no change is missed
+    taskENTER_CRITICAL();
+    for (page = 0; page < (DISPLAY_HEIGHT/8); page++)
+    {
+        if (dirty->first[page] > dirty->last[page]) continue;
+
+        if (dirty->first[page] < disp->dirty_first[page]) disp->dirty_first[page] = dirty->first[page];
+        if (dirty->last[page] > disp->dirty_last[page]) disp->dirty_last[page] = dirty->last[page];
+        changed = 1;
+    }
+
+    notify = changed && !(disp->status & NEED_UPDATE);
+    if (changed) disp->status |= NEED_UPDATE;
+    taskEXIT_CRITICAL();
+
+    if (notify) uc1701_update_request(disp);
+}
+
+// returns the sum of the widths of the chars which come before the char c of a proportional font
+static uint16_t glyph_offset(const uint8_t *font, uint8_t c)
+{
+    uint8_t i, j;
+    uint16_t offset;
+    uint8_t char_count = font[FONT_CHAR_COUNT];
+
+    for (i = 0; i < GLYPH_INDEX_FONTS; i++)
+    {
+        glyph_index_t *index = &g_glyph_index[i];
+
+        if (index->font == font)
+            return index->offset[c];
+
+        if (!index->font && char_count <= GLYPH_INDEX_CHARS)
+        {
+            taskENTER_CRITICAL();
+
+            // another task may have taken this entry meanwhile
+            if (!index->font)
+            {
+                offset = 0;
+                for (j = 0; j < char_count; j++)
+                {
+                    index->offset[j] = offset;
+                    offset += font[FONT_WIDTH_TABLE + j];
+                }
+
+                index->font = font;
+            }
+
+            taskEXIT_CRITICAL();
+
+            if (index->font == font)
+                return index->offset[c];
+        }
+    }
+
+    // no index for this font, sums the widths
+    offset = 0;
+    for (i = 0; i < c; i++) offset += font[FONT_WIDTH_TABLE + i];
+
+    return offset;
+}
+
 static void write_cmd(uc1701_t *disp, uint8_t cmd)
 {
     // activate chip select
@@ -125,14 +225,28 @@ static void write_double_cmd(uc1701_t *disp, uint8_t cmd, uint8_t data)
     SET_PIN(disp->cs_port, disp->cs_pin);
 }
 
-static void write_data(uc1701_t *disp, uint16_t data)
+static void write_data(uc1701_t *disp, const uint8_t *data, uint32_t size)
 {
     // activate chip select
     CLR_PIN(disp->cs_port, disp->cs_pin);
 
     // data mode
     SET_PIN(disp->cd_port, disp->cd_pin);
-    SEND_DATA(disp, data);
+
+    // streams the whole span through the SSP FIFO, the interrupts
+    // are only masked while the FIFO is being refilled
+    while (size)
+    {
+        taskENTER_CRITICAL();
+        while (size && SSP_GetStatus(disp->ssp_module, SSP_STAT_TXFIFO_NOTFULL) == SET)
+        {
+            SSP_SendData(disp->ssp_module, *data++);
+            size--;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    WAIT_SEND_DONE(disp);
 
     // deactivate chip select
     SET_PIN(disp->cs_port, disp->cs_pin);
@@ -162,7 +276,7 @@ static uint8_t read_byte(uc1701_t *disp, uint8_t x, uint8_t y)
     }
 }
 
-static void write_byte(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t data)
+static void write_byte(uc1701_t *disp, dirty_t *dirty, uint8_t x, uint8_t y, uint8_t data)
 {
     uint8_t data_tmp, y_offset;
 
@@ -173,20 +287,37 @@ static void write_byte(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t data)
         // first page
         data_tmp = READ_BUFFER(disp, x, y);
         data_tmp |= (data << y_offset);
-        WRITE_BUFFER(disp, x, y, data_tmp);
+        WRITE_BUFFER(disp, dirty, x, y, data_tmp);
 
         // second page
         y += 8;
         data_tmp = READ_BUFFER(disp, x, y);
         data_tmp |= data >> (8 - y_offset);
-        WRITE_BUFFER(disp, x, y, data_tmp);
+        WRITE_BUFFER(disp, dirty, x, y, data_tmp);
     }
     else
     {
-        WRITE_BUFFER(disp, x, y, data);
+        WRITE_BUFFER(disp, dirty, x, y, data);
     }
 }
 
+static void set_pixel(uc1701_t *disp, dirty_t *dirty, uint8_t x, uint8_t y, uint8_t color)
+{
+    // avoid x, y be out of the bounds
+    x %= DISPLAY_WIDTH;
+    y %= DISPLAY_HEIGHT;
+
+    uint8_t data = READ_BUFFER(disp, x, y);
+
+    // clear the bit
+    data &= ~(1 << (y % 8));
+
+    // set bit color
+    data |= ((color & 0x01) << (y % 8));
+
+    WRITE_BUFFER(disp, dirty, x, y, data);
+}
+
 
 /*
 ************************************************************************************************************************
@@ -272,6 +403,7 @@ void uc1701_init(uc1701_t *disp)
 
     // clear display
     uc1701_clear(disp, UC1701_WHITE);
+    uc1701_present(disp);
     uc1701_update(disp);
 
     DELAY_ms(2);
@@ -287,15 +419,14 @@ void uc1701_init(uc1701_t *disp)
 
 void uc1701_set_custom_value(uc1701_t *disp, uint8_t custom_pm, uint8_t custom_rr)
 {
-    // resistor ratio
-    write_cmd(disp, UC1701_SET_RR | custom_rr);
-
-    // set eletronic volume (PM)
-    write_double_cmd(disp, UC1701_SET_PM, custom_pm);
-
-    DELAY_ms(2);
-
-    uc1701_update(disp);
+    // the values are sent by the next update, so the SSP is only used from where the display is updated
+    taskENTER_CRITICAL();
+    disp->custom_pm = custom_pm;
+    disp->custom_rr = custom_rr;
+    disp->status |= NEED_CONFIG;
+    taskEXIT_CRITICAL();
+
+    uc1701_update_request(disp);
 }
 
 void uc1701_backlight(uc1701_t *disp, uint8_t state)
@@ -309,6 +440,7 @@ void uc1701_backlight(uc1701_t *disp, uint8_t state)
 void uc1701_clear(uc1701_t *disp, uint8_t color)
 {
     uint8_t i, j;
+    dirty_t dirty;
 
     for (i = 0; i < DISPLAY_WIDTH; i++)
     {
@@ -318,68 +450,107 @@ void uc1701_clear(uc1701_t *disp, uint8_t color)
         }
     }
 
-    disp->status |= NEED_UPDATE;
+    dirty_init(&dirty);
+    for (j = 0; j < (DISPLAY_HEIGHT/8); j++)
+        dirty_mark(&dirty, j, 0, DISPLAY_WIDTH - 1);
+
+    need_update(disp, &dirty);
+}
+
+void uc1701_present(uc1701_t *disp)
+{
+    uint8_t i, first, last;
+
+    if (!(disp->status & NEED_UPDATE)) return;
+
+    // the changed spans of all pages are taken at once, so no change is missed, the spans of
+    // the frame which were not sent yet are merged with them
+    taskENTER_CRITICAL();
+    for (i = 0; i < (DISPLAY_HEIGHT/8); i++)
+    {
+        first = disp->dirty_first[i];
+        last = disp->dirty_last[i];
+        disp->dirty_first[i] = DISPLAY_WIDTH;
+        disp->dirty_last[i] = 0;
+
+        if (first > last) continue;
+
+        memcpy(&disp->frame[i][first], &disp->buffer[i][first], (last - first) + 1);
+
+        if (first < disp->send_first[i]) disp->send_first[i] = first;
+        if (last > disp->send_last[i]) disp->send_last[i] = last;
+    }
+    disp->status &= ~NEED_UPDATE;
+    taskEXIT_CRITICAL();
 }
 
 void uc1701_update(uc1701_t *disp)
 {
-    if (disp->status & NEED_UPDATE)
+    uint8_t i, first, last, column;
+
+    if (disp->status & NEED_CONFIG)
     {
-        int i, j;
+        uint8_t custom_pm, custom_rr;
 
-        disp->status |= UPDATING;
+        taskENTER_CRITICAL();
+        custom_pm = disp->custom_pm;
+        custom_rr = disp->custom_rr;
+        disp->status &= ~NEED_CONFIG;
+        taskEXIT_CRITICAL();
 
-        for(i = 0; i < (DISPLAY_HEIGHT/8); i++)
-        {
-            // set page address
-            write_cmd(disp, UC1701_SET_PA + i);
+        // resistor ratio
+        write_cmd(disp, UC1701_SET_RR | custom_rr);
+
+        // set eletronic volume (PM)
+        write_double_cmd(disp, UC1701_SET_PM, custom_pm);
+
+        DELAY_ms(2);
+    }
+
+    // the frame is only changed by the present, which is called from the same task, so its
+    // spans are sent as they are, the drawings made after the last present wait for the next one
+    for (i = 0; i < (DISPLAY_HEIGHT/8); i++)
+    {
+        first = disp->send_first[i];
+        last = disp->send_last[i];
+        disp->send_first[i] = DISPLAY_WIDTH;
+        disp->send_last[i] = 0;
+
+        // only the changed columns of each page are sent
+        if (first > last) continue;
+
+        // set page address
+        write_cmd(disp, UC1701_SET_PA + i);
 
-            // set column address to first display address, considering
-            // direction and difference of columns between display/chip
-            write_cmd(disp, UC1701_SET_CA_MSB);
+        // set column address to first changed display address, considering
+        // direction and difference of columns between display/chip
 #ifdef UC1701_REVERSE_COLUMNS
-            write_cmd(disp, UC1701_SET_CA_LSB + (CHIP_COLUMNS - DISPLAY_WIDTH));
+        column = first + (CHIP_COLUMNS - DISPLAY_WIDTH);
 #else
-            write_cmd(disp, UC1701_SET_CA_LSB);
+        column = first;
 #endif
+        write_cmd(disp, UC1701_SET_CA_MSB | ((column >> 4) & UC1701_SET_CA_MASK));
+        write_cmd(disp, UC1701_SET_CA_LSB | (column & UC1701_SET_CA_MASK));
 
-            for(j = 0; j < DISPLAY_WIDTH; j++)
-            {
-                if (disp->status & FORCE_REFRESH)
-                {
-                    i = -1;
-                    disp->status &= ~FORCE_REFRESH;
-                    break;
-                }
-
-                write_data(disp, disp->buffer[i][j]);
-            }
-        }
-
-        disp->status &= ~(NEED_UPDATE | UPDATING);
+        write_data(disp, &disp->frame[i][first], (last - first) + 1);
     }
 }
 
 void uc1701_set_pixel(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t color)
 {
-    // avoid x, y be out of the bounds
-    x %= DISPLAY_WIDTH;
-    y %= DISPLAY_HEIGHT;
-
-    uint8_t data = READ_BUFFER(disp, x, y);
-
-    // clear the bit
-    data &= ~(1 << (y % 8));
-
-    // set bit color
-    data |= ((color & 0x01) << (y % 8));
+    dirty_t dirty;
 
-    WRITE_BUFFER(disp, x, y, data);
+    dirty_init(&dirty);
+    set_pixel(disp, &dirty, x, y, color);
+    need_update(disp, &dirty);
 }
 
 void uc1701_hline(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t color)
 {
     uint8_t i = 0, tmp = color;
+    dirty_t dirty;
+
+    dirty_init(&dirty);
 
     while (width--)
     {
@@ -395,13 +566,18 @@ void uc1701_hline(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t c
         }
         i++;
 
-        uc1701_set_pixel(disp, x++, y, tmp);
+        set_pixel(disp, &dirty, x++, y, tmp);
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_vline(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t height, uint8_t color)
 {
     uint8_t i = 0, tmp = color;
+    dirty_t dirty;
+
+    dirty_init(&dirty);
 
     while (height--)
     {
@@ -417,8 +593,10 @@ void uc1701_vline(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t height, uint8_t
         }
         i++;
 
-        uc1701_set_pixel(disp, x, y++, tmp);
+        set_pixel(disp, &dirty, x, y++, tmp);
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_line(uc1701_t *disp, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color)
@@ -440,6 +618,9 @@ void uc1701_line(uc1701_t *disp, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2,
         SWAP(y1, y2);
     }
 
+    dirty_t dirty;
+    dirty_init(&dirty);
+
     deltax = x2 - x1;
     deltay = ABS_DIFF(y2, y1);
     error = deltax / 2;
@@ -463,8 +644,8 @@ void uc1701_line(uc1701_t *disp, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2,
         }
         i++;
 
-        if (steep) uc1701_set_pixel(disp, y, x, tmp);
-        else uc1701_set_pixel(disp, x, y, tmp);
+        if (steep) set_pixel(disp, &dirty, y, x, tmp);
+        else set_pixel(disp, &dirty, x, y, tmp);
 
         error = error - deltay;
         if (error < 0)
@@ -473,6 +654,8 @@ void uc1701_line(uc1701_t *disp, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2,
             error = error + deltax;
         }
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_rect(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
@@ -485,25 +668,71 @@ void uc1701_rect(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t he
 
 void uc1701_rect_fill(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
 {
-    uint8_t i = 0, tmp = color;
+    uint8_t i, page, first_page, last_page, mask, pattern, stripes;
+    uint8_t *buffer;
+    dirty_t dirty;
 
-    while (width--)
+    // clips the rect to the display
+    if (x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT || width == 0 || height == 0) return;
+    if (width > (DISPLAY_WIDTH - x)) width = DISPLAY_WIDTH - x;
+    if (height > (DISPLAY_HEIGHT - y)) height = DISPLAY_HEIGHT - y;
+
+    // the rows stripes start with a black row at the top of the rect
+    stripes = (y % 2) ? 0xAA : 0x55;
+
+    switch (color)
+    {
+        case UC1701_WHITE: pattern = 0x00; break;
+        case UC1701_BLACK: pattern = 0xFF; break;
+        case UC1701_BLACK_WHITE: pattern = stripes; break;
+        case UC1701_WHITE_BLACK: pattern = ~stripes; break;
+        case UC1701_CHESS: pattern = stripes; break;
+        default: pattern = (color & 0x01) ? 0xFF : 0x00; break;
+    }
+
+    first_page = y / 8;
+    last_page = (y + height - 1) / 8;
+    dirty_init(&dirty);
+
+    for (page = first_page; page <= last_page; page++)
     {
-        if (color == UC1701_CHESS)
+        // the partial pages at the top and bottom keep the rows outside of the rect
+        mask = 0xFF;
+        if (page == first_page) mask &= 0xFF << (y % 8);
+        if (page == last_page) mask &= 0xFF >> (7 - ((y + height - 1) % 8));
+
+        // the columns are stored from right to left, the rect starts at its last column
+        buffer = &disp->buffer[page][DISPLAY_WIDTH - x - width];
+
+        if (mask == 0xFF && color != UC1701_CHESS)
         {
-            if ((i % 2) == 0) tmp = UC1701_BLACK_WHITE;
-            else tmp = UC1701_WHITE_BLACK;
+            memset(buffer, pattern, width);
+        }
+        else
+        {
+            for (i = 0; i < width; i++)
+            {
+                uint8_t data = pattern;
+
+                // the chess alternates the stripes every column, starting with the first column (x)
+                if (color == UC1701_CHESS && ((width - 1 - i) % 2)) data = ~stripes;
+
+                buffer[i] = (buffer[i] & ~mask) | (data & mask);
+            }
         }
-        i++;
 
-        uc1701_vline(disp, x++, y, height, tmp);
+        dirty_mark(&dirty, page, DISPLAY_WIDTH - x - width, (DISPLAY_WIDTH - 1) - x);
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_rect_invert(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t height)
 {
     uint8_t mask, page_offset, h, i, data, data_tmp, x_tmp;
+    dirty_t dirty;
 
+    dirty_init(&dirty);
     page_offset = y % 8;
     mask = 0xFF;
     if (height < (8 - page_offset))
@@ -525,7 +754,7 @@ void uc1701_rect_invert(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uin
         data = READ_BUFFER(disp, x_tmp, y);
         data_tmp = ~data;
         data = (data_tmp & mask) | (data & ~mask);
-        WRITE_BUFFER(disp, x_tmp, y, data);
+        WRITE_BUFFER(disp, &dirty, x_tmp, y, data);
     }
 
     // Now do the full pages
@@ -539,7 +768,7 @@ void uc1701_rect_invert(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uin
             x_tmp = x + i;
 
             data = READ_BUFFER(disp, x_tmp, y);
-            WRITE_BUFFER(disp, x_tmp, y, ~data);
+            WRITE_BUFFER(disp, &dirty, x_tmp, y, ~data);
         }
     }
 
@@ -556,28 +785,62 @@ void uc1701_rect_invert(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uin
             data = READ_BUFFER(disp, x_tmp, y);
             data_tmp = ~data;
             data = (data_tmp & mask) | (data & ~mask);
-            WRITE_BUFFER(disp, x_tmp, y, data);
+            WRITE_BUFFER(disp, &dirty, x_tmp, y, data);
         }
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_draw_image(uc1701_t *disp, uint8_t x, uint8_t y, const uint8_t *image, uint8_t color)
 {
-    uint8_t i, j, height, width;
-    char data;
+    uint8_t i, height, width, columns, offset, data;
+    uint16_t row, page;
+    uint8_t *buffer;
+    dirty_t dirty;
 
     width = (uint8_t) *image++;
     height = (uint8_t) *image++;
 
-    for (j = 0; j < height; j += 8)
+    // clips the image to the display
+    if (x >= DISPLAY_WIDTH) return;
+    columns = (width > (DISPLAY_WIDTH - x)) ? (DISPLAY_WIDTH - x) : width;
+
+    // each image byte is split between two pages when y is not aligned to a page
+    offset = y % 8;
+    dirty_init(&dirty);
+
+    for (row = 0; row < height; row += 8, image += width)
     {
-        for(i = 0; i < width; i++)
+        page = (y + row) / 8;
+        if (page >= (DISPLAY_HEIGHT/8)) break;
+
+        // the columns are stored from right to left
+        buffer = &disp->buffer[page][(DISPLAY_WIDTH - 1) - x];
+
+        for (i = 0; i < columns; i++)
         {
-            data = *image++;
+            data = image[i];
             if (color == UC1701_WHITE) data = ~data;
-            WRITE_BUFFER(disp, x+i, y+j, data);
+
+            if (offset == 0)
+            {
+                *(buffer - i) = data;
+            }
+            else
+            {
+                *(buffer - i) = (*(buffer - i) & ~(0xFF << offset)) | (data << offset);
+                if ((page + 1) < (DISPLAY_HEIGHT/8))
+                    buffer[DISPLAY_WIDTH - i] = (buffer[DISPLAY_WIDTH - i] & ~(0xFF >> (8 - offset))) | (data >> (8 - offset));
+            }
         }
+
+        dirty_mark(&dirty, page, DISPLAY_WIDTH - x - columns, (DISPLAY_WIDTH - 1) - x);
+        if (offset && (page + 1) < (DISPLAY_HEIGHT/8))
+            dirty_mark(&dirty, page + 1, DISPLAY_WIDTH - x - columns, (DISPLAY_WIDTH - 1) - x);
     }
+
+    need_update(disp, &dirty);
 }
 
 void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const uint8_t *font, uint8_t color)
@@ -591,6 +854,9 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
     uint8_t height = font[FONT_HEIGHT];
     uint8_t first_char = font[FONT_FIRST_CHAR];
     uint8_t char_count = font[FONT_CHAR_COUNT];
+    dirty_t dirty;
+
+    dirty_init(&dirty);
 
     while (*text)
     {
@@ -611,9 +877,7 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
         else
         {
             width = font[FONT_WIDTH_TABLE + c];
-            char_data_index = 0;
-            for (i = 0; i < c; i++) char_data_index += font[FONT_WIDTH_TABLE + i];
-            char_data_index = (char_data_index * bytes) + FONT_WIDTH_TABLE + char_count;
+            char_data_index = (glyph_offset(font, c) * bytes) + FONT_WIDTH_TABLE + char_count;
         }
 
         y_tmp = y;
@@ -628,6 +892,29 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
             x_tmp = x;
             page = j * width;
 
+            // a whole piece aligned to a page is copied straight into the buffer
+            if ((y_tmp % 8) == 0 && y_tmp < DISPLAY_HEIGHT && !(height > 8 && height < (j + 1) * 8))
+            {
+                uint8_t *buffer = &disp->buffer[y_tmp / 8][(DISPLAY_WIDTH - 1) - x];
+                const uint8_t *glyph = &font[char_data_index + page];
+                uint8_t span = width;
+
+                for (i = 0; i < width; i++)
+                    *(buffer - i) = (color == UC1701_WHITE) ? (uint8_t) ~glyph[i] : glyph[i];
+
+                // draws the interchar space
+                if (*(text + 1) != '\0' && (x + width) < DISPLAY_WIDTH)
+                {
+                    *(buffer - width) = (color == UC1701_BLACK ? 0x00 : 0xFF);
+                    span++;
+                }
+
+                dirty_mark(&dirty, y_tmp / 8, (DISPLAY_WIDTH - x) - span, (DISPLAY_WIDTH - 1) - x);
+
+                y_tmp += 8;
+                continue;
+            }
+
             // draws the character
             for (i = 0; i < width; i++)
             {
@@ -641,7 +928,7 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
                     data = read_byte(disp, x_tmp, y_tmp) | data;
                 }
 
-                write_byte(disp, x_tmp, y_tmp, data);
+                write_byte(disp, &dirty, x_tmp, y_tmp, data);
 
                 x_tmp++;
             }
@@ -656,7 +943,7 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
 
             if (*(text + 1) != '\0')
             {
-                write_byte(disp, x_tmp, y_tmp, data);
+                write_byte(disp, &dirty, x_tmp, y_tmp, data);
             }
 
             y_tmp += 8;
@@ -666,4 +953,6 @@ void uc1701_text(uc1701_t *disp, uint8_t x, uint8_t y, const char *text, const u
 
         text++;
     }
+
+    need_update(disp, &dirty);
 }
\ No newline at end of file
@@ -104,10 +104,10 @@
 #define configMAX_TASK_NAME_LEN             ( 8 )
 #define configUSE_16_BIT_TICKS              0
 #define configIDLE_SHOULD_YIELD             0
-#define configUSE_MUTEXES                   0
+#define configUSE_MUTEXES                   1
 #define configUSE_COUNTING_SEMAPHORES       1
 #define configUSE_ALTERNATIVE_API           0
-#define configUSE_RECURSIVE_MUTEXES         0
+#define configUSE_RECURSIVE_MUTEXES         1
 #define configQUEUE_REGISTRY_SIZE           10
 #define configUSE_QUEUE_SETS                0
 #define configUSE_TIME_SLICING              0
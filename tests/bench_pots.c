@@ -0,0 +1,197 @@
+/*
+ * actuator: events sent by a pot at rest, swept slowly and swept fast, with the adaptive filter and with
+ * the fixed IIR filter it replaced, and how far the value reported lags behind the pot
+ *
+ * the traces are generated: the oversampled sum of the pot position plus gaussian noise, replayed into
+ * both filters
+ */
+
+#include "mock.h"
+#include "actuator.h"
+#include "hardware.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define CHANNEL         0
+#define OVERSAMPLING    (1 << POT_OVERSAMPLING_SHIFT)
+#define ADC_MAX         4095
+
+#define TRACE_TICKS     10000
+
+// the fixed IIR filter, the state is the oversampled sum times 2^shift
+#define IIR_FILTER_SHIFT    7
+
+typedef struct TRACE_T {
+    const char *name;
+    double (*position)(uint32_t t);
+    // of the conversions, in LSB
+    double noise;
+} trace_t;
+
+typedef struct RESULT_T {
+    uint32_t events;
+    double max_lag;
+} result_t;
+
+static const uint8_t POT_PINS[] = {0, 23, 1, CHANNEL};
+
+static pot_t g_pot;
+static uint32_t g_pots_sums[8];
+static uint32_t g_sums[TRACE_TICKS];
+
+uint32_t hardware_timestamp(void)
+{
+    return 0;
+}
+
+const volatile uint32_t *hardware_pots_sums(void)
+{
+    return g_pots_sums;
+}
+
+static double rest(uint32_t t)
+{
+    (void) t;
+    return 2000;
+}
+
+// the whole range in 10 seconds
+static double slow_sweep(uint32_t t)
+{
+    return 500 + t * 0.3;
+}
+
+// the whole range in 300 ms, back and forth
+static double fast_sweep(uint32_t t)
+{
+    uint32_t phase = t % 600;
+    return (phase < 300) ? (500 + phase * 10.0) : (3500 - (phase - 300) * 10.0);
+}
+
+static const trace_t g_traces[] = {
+    {"rest", rest, 2.0},
+    {"noisy rest", rest, 16.0},
+    {"slow sweep", slow_sweep, 2.0},
+    {"fast sweep", fast_sweep, 2.0},
+};
+
+static double gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static void generate(const trace_t *trace)
+{
+    uint32_t t, i, sum;
+    double sample;
+
+    srand(1);
+    for (t = 0; t < TRACE_TICKS; t++)
+    {
+        sum = 0;
+        for (i = 0; i < OVERSAMPLING; i++)
+        {
+            sample = trace->position(t) + trace->noise * gauss();
+            if (sample < 0) sample = 0;
+            if (sample > ADC_MAX) sample = ADC_MAX;
+            sum += (uint32_t) lround(sample);
+        }
+
+        g_sums[t] = sum;
+    }
+}
+
+static void update_lag(result_t *result, const trace_t *trace, uint32_t t, uint16_t value)
+{
+    double lag = fabs(trace->position(t) - value);
+    if (lag > result->max_lag) result->max_lag = lag;
+}
+
+// both filters start from the first sum, so only the trace itself sends events
+static result_t replay_iir(const trace_t *trace)
+{
+    result_t result = {0, 0};
+    uint32_t state = g_sums[0] << IIR_FILTER_SHIFT;
+    uint16_t value = g_sums[0] >> POT_OVERSAMPLING_SHIFT, val;
+    uint32_t t;
+
+    for (t = 0; t < TRACE_TICKS; t++)
+    {
+        state = state + g_sums[t] - (state >> IIR_FILTER_SHIFT);
+        val = state >> (IIR_FILTER_SHIFT + POT_OVERSAMPLING_SHIFT);
+
+        if ((val > value) ? ((val - value) > POT_THRESHOLD) : ((value - val) > POT_THRESHOLD))
+        {
+            value = val;
+            result.events++;
+        }
+
+        update_lag(&result, trace, t, value);
+    }
+
+    return result;
+}
+
+static void pot_event(void *actuator)
+{
+    (void) actuator;
+}
+
+static result_t replay_adaptive(const trace_t *trace)
+{
+    result_t result = {0, 0};
+    uint32_t t;
+
+    // the pot is registered once, each trace starts its filter over from the first sum
+    g_pot.value = 0;
+    g_pot.speed = 0;
+    g_pot.filter_init = 0;
+
+    g_pots_sums[CHANNEL] = g_sums[0] | HARDWARE_POT_SUM_VALID;
+    actuators_clock();
+
+    for (t = 0; t < TRACE_TICKS; t++)
+    {
+        g_pots_sums[CHANNEL] = g_sums[t] | HARDWARE_POT_SUM_VALID;
+        actuators_clock();
+
+        if (actuator_get_status(&g_pot) & EV_POT_TURNED) result.events++;
+
+        update_lag(&result, trace, t, actuator_pot_value(0));
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    result_t iir, adaptive;
+    uint32_t i;
+
+    actuator_create(POT, 0, &g_pot);
+    actuator_set_pins(&g_pot, POT_PINS);
+    actuator_set_prop(&g_pot, POT_MIN_CUTOFF, DEFAULT_POT_MIN_CUTOFF);
+    actuator_set_prop(&g_pot, POT_BETA, DEFAULT_POT_BETA);
+    actuator_enable_event(&g_pot, EV_POT_TURNED);
+    actuator_set_event(&g_pot, pot_event);
+
+    printf("pot events and max lag (LSB), %u ticks per trace\n", TRACE_TICKS);
+    printf("  %-12s %6s %10s %10s %10s %10s\n", "trace", "noise", "iir", "lag", "adaptive", "lag");
+
+    for (i = 0; i < sizeof(g_traces) / sizeof(g_traces[0]); i++)
+    {
+        generate(&g_traces[i]);
+
+        iir = replay_iir(&g_traces[i]);
+        adaptive = replay_adaptive(&g_traces[i]);
+
+        printf("  %-12s %6.1f %10u %10.0f %10u %10.0f\n", g_traces[i].name, g_traces[i].noise,
+               iir.events, iir.max_lag, adaptive.events, adaptive.max_lag);
+    }
+
+    return 0;
+}
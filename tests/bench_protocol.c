@@ -0,0 +1,165 @@
+/*
+ * protocol: cost of finding the command of a message, through the index of the first tokens against
+ * the linear scan of the commands table it replaced
+ *
+ * the table is the one protocol_init registers, each message is made of the tokens of its command
+ * with the wildcards filled in, the figures are of the host running it, they only compare the two
+ */
+
+#include "mock.h"
+
+// the module is included to reach the commands table and the dispatch index
+#include "../app/src/protocol.c"
+
+#include <time.h>
+
+#define ROUNDS          200000
+#define MAX_TOKENS      32
+
+// the commands in the order protocol_init registers them
+static const char *g_table[] = {
+    CMD_PING, CMD_SAY, CMD_LED, CMD_GLCD_TEXT, CMD_GLCD_DIALOG, CMD_GLCD_DRAW, CMD_DISP_BRIGHTNESS,
+    CMD_GUI_CONNECTED, CMD_GUI_DISCONNECTED, CMD_CONTROL_ADD, CMD_CONTROL_REMOVE, CMD_CONTROL_SET,
+    CMD_CONTROL_GET, CMD_INITIAL_STATE, CMD_TUNER, CMD_RESPONSE, CMD_RESTORE, CMD_DUO_BOOT,
+    CMD_MENU_ITEM_CHANGE, CMD_PEDALBOARD_CLEAR, CMD_PEDALBOARD_NAME_SET, CMD_DUOX_PAGES_AVAILABLE,
+    CMD_SELFTEST_SAVE_POT_CALIBRATION, CMD_SELFTEST_SKIP_CONTROL_ENABLE, CMD_SELFTEST_CHECK_CALIBRATION,
+    CMD_RESET_EEPROM, CMD_DUOX_SET_CONTRAST, CMD_DUOX_EXP_OVERCURRENT, CMD_SYS_LAUNCH_POPUP,
+    CMD_SYS_CHANGE_LED_BLINK, CMD_SYS_CHANGE_LED_BRIGHTNESS, CMD_SYS_CHANGE_NAME, CMD_SYS_CHANGE_UNIT,
+    CMD_SYS_CHANGE_VALUE, CMD_SYS_CHANGE_WIDGET_INDICATOR, CMD_PEDALBOARD_CHANGE, CMD_TAGGED_RESPONSE,
+    CMD_PIPELINE, CMD_CONTROL_STATS, CMD_POT_FILTER_SET, CMD_POT_FILTER_GET,
+};
+
+#define TABLE_SIZE      (sizeof(g_table) / sizeof(g_table[0]))
+
+static char *g_tokens[TABLE_SIZE][MAX_TOKENS];
+static proto_t g_messages[TABLE_SIZE];
+
+// the scan of protocol_parse before the index, every command is compared from the first one
+static int32_t linear_lookup(const proto_t *proto)
+{
+    uint32_t i, j, match, variable_arguments = 0;
+
+    for (i = 0; i < g_command_count; i++)
+    {
+        match = 0;
+
+        for (j = 0; j < proto->list_count && j < g_commands[i].count; j++)
+        {
+            if (strcmp(g_commands[i].list[j], proto->list[j]) == 0)
+            {
+                match++;
+            }
+            else if (match > 0)
+            {
+                if (is_wildcard(g_commands[i].list[j])) match++;
+                else if (strcmp(g_commands[i].list[j], "...") == 0)
+                {
+                    match++;
+                    variable_arguments = 1;
+                }
+            }
+        }
+
+        if (match > 0)
+        {
+            if (j < g_commands[i].count)
+            {
+                if (strcmp(g_commands[i].list[j], "...") == 0) variable_arguments = 1;
+            }
+
+            if (proto->list_count < (g_commands[i].count - variable_arguments)) return FEW_ARGUMENTS;
+            if (proto->list_count > g_commands[i].count && !variable_arguments) return MANY_ARGUMENTS;
+            if (match == proto->list_count || variable_arguments) return i;
+
+            return NOT_FOUND;
+        }
+    }
+
+    return NOT_FOUND;
+}
+
+static int32_t indexed_lookup(const proto_t *proto)
+{
+    int32_t index = dispatch_lookup(proto->list[0]);
+    if (index >= 0) index = match_command(index, proto);
+
+    return index;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// nanoseconds per lookup of the messages from first to last
+static double time_lookups(int32_t (*lookup)(const proto_t *), uint32_t first, uint32_t last, int32_t *sum)
+{
+    uint32_t round, i;
+    double start = now();
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (i = first; i <= last; i++)
+            *sum += lookup(&g_messages[i]);
+    }
+
+    return (now() - start) * 1e9 / ((double) ROUNDS * (last - first + 1));
+}
+
+static void report(const char *name, uint32_t first, uint32_t last, int32_t *sum)
+{
+    double linear = time_lookups(linear_lookup, first, last, sum);
+    double indexed = time_lookups(indexed_lookup, first, last, sum);
+
+    printf("  %-16s %7.1f ns %7.1f ns %6.1fx\n", name, linear, indexed, linear / indexed);
+}
+
+int main(void)
+{
+    static char unknown_token[] = "unknown", *unknown_list[] = {unknown_token, NULL};
+    uint32_t i, j;
+    int32_t sum = 0;
+
+    for (i = 0; i < TABLE_SIZE; i++)
+        protocol_add_command(g_table[i], NULL);
+
+    // each message holds the command tokens, the wildcards filled in and the variable arguments left out
+    for (i = 0; i < TABLE_SIZE; i++)
+    {
+        proto_t *proto = &g_messages[i];
+
+        proto->list = g_tokens[i];
+        proto->list_count = 0;
+
+        for (j = 0; j < g_commands[i].count && j < MAX_TOKENS - 1; j++)
+        {
+            const char *token = g_commands[i].list[j];
+
+            if (strcmp(token, "...") == 0) continue;
+            proto->list[proto->list_count++] = is_wildcard(token) ? "1" : (char *) token;
+        }
+
+        // both lookups find the same command
+        if (linear_lookup(proto) != indexed_lookup(proto))
+        {
+            printf("%s: the lookups differ\n", g_table[i]);
+            return 1;
+        }
+    }
+
+    printf("protocol, %u commands, linear scan against index\n", (unsigned) TABLE_SIZE);
+    report("all commands", 0, TABLE_SIZE - 1, &sum);
+    report("first command", 0, 0, &sum);
+    report("last command", TABLE_SIZE - 1, TABLE_SIZE - 1, &sum);
+
+    // a command not in the table is compared against all of them by the scan
+    g_messages[0].list = unknown_list;
+    g_messages[0].list_count = 1;
+    report("not found", 0, 0, &sum);
+
+    // keeps the lookups from being optimized out
+    return sum == 0x7FFFFFFF;
+}
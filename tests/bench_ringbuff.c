@@ -0,0 +1,308 @@
+/*
+ * utils: ring buffer throughput of write, read and read_until in bytes per second, against the
+ * byte by byte implementation with modulo indexes it replaced
+ *
+ * serial: cost per KB of handing the received messages to the protocol parser, through the two ring
+ * buffers and the message buffer of the byte by byte implementation, against the frames of the serial
+ * rx buffer which are scanned when published and copied once when read
+ *
+ * the figures are of the host running it, they only compare the two implementations
+ */
+
+#include "mock.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the serial buffers were created with one byte more than the protocol messages size
+#define BUFFER_SIZE     4096
+#define MESSAGE_SIZE    32
+#define TOTAL_BYTES     (16UL * 1024 * 1024)
+
+// bytes published by each uart interrupt, a FIFO worth
+#define BURST_SIZE      16
+
+typedef struct BYTES_RINGBUFF_T {
+    uint32_t head, tail;
+    uint8_t *buffer;
+    uint32_t size;
+} bytes_ringbuff_t;
+
+#define BYTES_IS_FULL(rb)       (rb->tail == (rb->head + 1) % rb->size)
+#define BYTES_IS_EMPTY(rb)      (rb->head == rb->tail)
+#define BYTES_INC(rb,idx)       (rb->idx = (rb->idx + 1) % rb->size)
+
+static uint32_t bytes_write(bytes_ringbuff_t *rb, const uint8_t *data, uint32_t data_size)
+{
+    uint32_t bytes = 0;
+
+    while (data_size > 0 && !BYTES_IS_FULL(rb))
+    {
+        rb->buffer[rb->head] = *data++;
+        BYTES_INC(rb, head);
+
+        data_size--;
+        bytes++;
+    }
+
+    return bytes;
+}
+
+static uint32_t bytes_read(bytes_ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size)
+{
+    uint32_t bytes = 0;
+
+    while (buffer_size > 0 && !BYTES_IS_EMPTY(rb))
+    {
+        *buffer++ = rb->buffer[rb->tail];
+        BYTES_INC(rb, tail);
+
+        buffer_size--;
+        bytes++;
+    }
+
+    return bytes;
+}
+
+static uint32_t bytes_count(bytes_ringbuff_t *rb, uint8_t byte)
+{
+    uint32_t count = 0, tail = rb->tail;
+
+    while (tail != rb->head)
+    {
+        if (rb->buffer[tail] == byte) count++;
+        tail = (tail + 1) % rb->size;
+    }
+
+    return count;
+}
+
+static uint32_t bytes_read_until(bytes_ringbuff_t *rb, uint8_t *buffer, uint32_t buffer_size, uint8_t token)
+{
+    uint32_t bytes = 0;
+
+    if (bytes_count(rb, token) > 0)
+    {
+        while (buffer_size > 0 && !BYTES_IS_EMPTY(rb))
+        {
+            *buffer = rb->buffer[rb->tail];
+            BYTES_INC(rb, tail);
+
+            buffer_size--;
+            bytes++;
+
+            if (*buffer++ == token) break;
+        }
+    }
+
+    return bytes;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, double seconds)
+{
+    printf("  %-12s %8.1f MB/s\n", name, TOTAL_BYTES / seconds / 1e6);
+}
+
+// time stamp counter of the host, zero where there is none
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void report_pipeline(const char *name, double seconds, uint64_t elapsed)
+{
+    double kbytes = TOTAL_BYTES / 1024.0;
+
+    printf("  %-12s %8.0f ns/KB %8.0f cycles/KB\n", name, seconds * 1e9 / kbytes, elapsed / kbytes);
+}
+
+// the uart interrupt copied the received bytes to the callback of ui_comm, which wrote them to its own
+// ring buffer and looked for the end of message, the task then read the message to its buffer
+static uint32_t bytes_pipeline(bytes_ringbuff_t *uart, bytes_ringbuff_t *comm, uint8_t *message)
+{
+    uint8_t burst[BURST_SIZE];
+    unsigned long done;
+    uint32_t i, size, messages = 0;
+
+    for (done = 0; done < TOTAL_BYTES; done += BURST_SIZE)
+    {
+        // the uart interrupt put the burst on the serial rx buffer
+        uart->head = (uart->head + BURST_SIZE) % uart->size;
+
+        size = bytes_read(uart, burst, sizeof(burst));
+        bytes_write(comm, burst, size);
+
+        for (i = 0; i < size; i++)
+        {
+            if (burst[i] == 0)
+            {
+                while (bytes_read_until(comm, message, BUFFER_SIZE, 0)) messages++;
+                break;
+            }
+        }
+    }
+
+    return messages;
+}
+
+// the interrupt publishes the bytes the DMA wrote and scans them for the end of frame, the task copies
+// the frame out and releases its space
+static uint32_t frames_pipeline(ringbuff_t *rb, uint8_t *linear)
+{
+    unsigned long done;
+    uint32_t scan = rb->head, frame_size = 0, frames = 0;
+    uint32_t mask = rb->size - 1;
+
+    for (done = 0; done < TOTAL_BYTES; done += BURST_SIZE)
+    {
+        ringbuff_publish(rb, rb->head + BURST_SIZE);
+
+        while (scan != rb->head)
+        {
+            uint32_t span = rb->size - scan;
+            uint32_t used = (rb->head - scan) & mask;
+            uint8_t *found, *data;
+
+            if (span > used) span = used;
+            found = memchr(&rb->buffer[scan], 0, span);
+            if (found) span = (found - &rb->buffer[scan]) + 1;
+            scan = (scan + span) & mask;
+            frame_size += span;
+
+            if (!found) continue;
+
+            // the frame read by the task
+            span = ringbuff_peek_span(rb, &data);
+            if (span >= frame_size)
+            {
+                memcpy(linear, data, frame_size);
+            }
+            else
+            {
+                memcpy(linear, data, span);
+                memcpy(&linear[span], rb->buffer, frame_size - span);
+            }
+            ringbuff_read(rb, NULL, frame_size);
+
+            frame_size = 0;
+            frames++;
+        }
+    }
+
+    return frames;
+}
+
+int main(void)
+{
+    static uint8_t message[MESSAGE_SIZE], buffer[BUFFER_SIZE];
+    ringbuff_t *rb = ringbuff_create(BUFFER_SIZE + 1);
+    bytes_ringbuff_t brb = {0, 0, malloc(BUFFER_SIZE + 1), BUFFER_SIZE + 1};
+    double write_time, read_time, until_time, start;
+    unsigned long done;
+    uint32_t i, sum = 0;
+
+    // the messages are zero terminated as the ones the protocol reads until the token
+    memset(message, 'a', sizeof(message));
+    message[MESSAGE_SIZE - 1] = 0;
+
+    // write and read: a batch of messages written and read back as one block
+    write_time = read_time = 0;
+    for (done = 0; done < TOTAL_BYTES; done += BUFFER_SIZE / 2)
+    {
+        start = now();
+        for (i = 0; i < BUFFER_SIZE / 2; i += MESSAGE_SIZE)
+            ringbuff_write(rb, message, MESSAGE_SIZE);
+        write_time += now() - start;
+
+        start = now();
+        sum += ringbuff_read(rb, buffer, BUFFER_SIZE);
+        read_time += now() - start;
+    }
+
+    until_time = 0;
+    for (done = 0; done < TOTAL_BYTES; done += BUFFER_SIZE / 2)
+    {
+        for (i = 0; i < BUFFER_SIZE / 2; i += MESSAGE_SIZE)
+            ringbuff_write(rb, message, MESSAGE_SIZE);
+
+        start = now();
+        while (ringbuff_read_until(rb, buffer, sizeof(buffer), 0)) sum++;
+        until_time += now() - start;
+    }
+
+    printf("ringbuff, %u bytes buffer, %u bytes messages\n", rb->size, MESSAGE_SIZE);
+    report("write", write_time);
+    report("read", read_time);
+    report("read_until", until_time);
+
+    write_time = read_time = 0;
+    for (done = 0; done < TOTAL_BYTES; done += BUFFER_SIZE / 2)
+    {
+        start = now();
+        for (i = 0; i < BUFFER_SIZE / 2; i += MESSAGE_SIZE)
+            bytes_write(&brb, message, MESSAGE_SIZE);
+        write_time += now() - start;
+
+        start = now();
+        sum += bytes_read(&brb, buffer, BUFFER_SIZE);
+        read_time += now() - start;
+    }
+
+    until_time = 0;
+    for (done = 0; done < TOTAL_BYTES; done += BUFFER_SIZE / 2)
+    {
+        for (i = 0; i < BUFFER_SIZE / 2; i += MESSAGE_SIZE)
+            bytes_write(&brb, message, MESSAGE_SIZE);
+
+        start = now();
+        while (bytes_read_until(&brb, buffer, sizeof(buffer), 0)) sum++;
+        until_time += now() - start;
+    }
+
+    printf("byte by byte, %u bytes buffer, %u bytes messages\n", brb.size, MESSAGE_SIZE);
+    report("write", write_time);
+    report("read", read_time);
+    report("read_until", until_time);
+
+    // both serial rx buffers hold the messages repeated, the bytes received are only published, the
+    // uart interrupt and the DMA which wrote them are left out
+    bytes_ringbuff_t uart = {0, 0, malloc(BUFFER_SIZE), BUFFER_SIZE};
+    bytes_ringbuff_t comm = {0, 0, malloc(BUFFER_SIZE), BUFFER_SIZE};
+    ringbuff_t *frames_rb = ringbuff_create(BUFFER_SIZE);
+    uint64_t start_cycles;
+
+    for (i = 0; i < BUFFER_SIZE; i += MESSAGE_SIZE)
+    {
+        memcpy(&uart.buffer[i], message, MESSAGE_SIZE);
+        memcpy(&frames_rb->buffer[i], message, MESSAGE_SIZE);
+    }
+
+    printf("serial to protocol, %u bytes bursts, %u bytes messages\n", BURST_SIZE, MESSAGE_SIZE);
+
+    start = now();
+    start_cycles = cycles();
+    sum += bytes_pipeline(&uart, &comm, buffer);
+    report_pipeline("three copies", now() - start, cycles() - start_cycles);
+
+    start = now();
+    start_cycles = cycles();
+    sum += frames_pipeline(frames_rb, buffer);
+    report_pipeline("frames", now() - start, cycles() - start_cycles);
+
+    // keeps the reads from being optimized out
+    return sum == 0;
+}
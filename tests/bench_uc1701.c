@@ -0,0 +1,87 @@
+/*
+ * uc1701: time per rect fill of the regions the screens clear the most, against drawing the rect
+ * column by column with vline as rect_fill did before
+ *
+ * the figures are of the host running it, they only compare the two ways of filling
+ */
+
+#include "mock.h"
+#include "uc1701.h"
+
+#include <time.h>
+
+#define FILLS       100000
+
+typedef struct REGION_T {
+    const char *name;
+    uint8_t x, y, width, height, color;
+} region_t;
+
+static const region_t g_regions[] = {
+    {"pot value", 90, 12, 38, 9, UC1701_WHITE},
+    {"peakmeter", 4, 20, 120, 30, UC1701_BLACK},
+    {"listbox", 0, 9, 128, 46, UC1701_WHITE},
+    {"screen", 0, 0, 128, 64, UC1701_WHITE},
+    {"chess", 0, 11, 128, 42, UC1701_CHESS},
+};
+
+static uc1701_t g_disp;
+
+void uc1701_update_request(uc1701_t *disp)
+{
+    (void) disp;
+}
+
+static void columns_fill(uc1701_t *disp, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
+{
+    uint8_t i = 0, tmp = color;
+
+    while (width--)
+    {
+        if (color == UC1701_CHESS)
+        {
+            if ((i % 2) == 0) tmp = UC1701_BLACK_WHITE;
+            else tmp = UC1701_WHITE_BLACK;
+        }
+        i++;
+
+        uc1701_vline(disp, x++, y, height, tmp);
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+    const region_t *region;
+    double start, pages_time, columns_time;
+    uint32_t i, j;
+
+    printf("rect fill, ns per fill\n");
+    printf("  %-12s %10s %10s\n", "region", "pages", "columns");
+
+    for (i = 0; i < sizeof(g_regions) / sizeof(g_regions[0]); i++)
+    {
+        region = &g_regions[i];
+
+        start = now();
+        for (j = 0; j < FILLS; j++)
+            uc1701_rect_fill(&g_disp, region->x, region->y, region->width, region->height, region->color);
+        pages_time = now() - start;
+
+        start = now();
+        for (j = 0; j < FILLS / 10; j++)
+            columns_fill(&g_disp, region->x, region->y, region->width, region->height, region->color);
+        columns_time = (now() - start) * 10;
+
+        printf("  %-12s %10.1f %10.1f\n", region->name, pages_time / FILLS * 1e9, columns_time / FILLS * 1e9);
+    }
+
+    return 0;
+}
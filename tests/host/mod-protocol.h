@@ -0,0 +1,59 @@
+/*
+ * Stand-in for the mod-protocol.h of the mod-controller-proto submodule, used by the unit tests when the
+ * submodule isn't checked out. Only the definitions the tested modules need are here, the commands
+ * keep the shape of the protocol ones but the tests don't depend on their exact text.
+ */
+
+#ifndef MOD_PROTOCOL_H
+#define MOD_PROTOCOL_H
+
+#define COMMAND_COUNT_DUOX                      36
+
+#define CMD_PING                                "pi"
+#define CMD_SAY                                 "say %s ..."
+#define CMD_LED                                 "l %i %i %i %i ..."
+#define CMD_GLCD_TEXT                           "glcd_text %i %i %i %s"
+#define CMD_GLCD_DIALOG                         "glcd_dialog %s"
+#define CMD_GLCD_DRAW                           "glcd_draw %i %i %i %s"
+#define CMD_GUI_CONNECTED                       "ui_con"
+#define CMD_GUI_DISCONNECTED                    "ui_dis"
+#define CMD_CONTROL_ADD                         "a %i %s %i %s %f %f %f %i %i %i %i %i ..."
+#define CMD_CONTROL_REMOVE                      "d %i ..."
+#define CMD_CONTROL_SET                         "s %i %f"
+#define CMD_CONTROL_GET                         "g %i"
+#define CMD_INITIAL_STATE                       "is %i %i %i %i %i %s %s ..."
+#define CMD_TUNER                               "ts %f %s %i"
+#define CMD_RESPONSE                            "r %i ..."
+#define CMD_RESTORE                             "restore"
+#define CMD_DUO_BOOT                            "boot %i %i %s"
+#define CMD_MENU_ITEM_CHANGE                    "c %i %i"
+#define CMD_PEDALBOARD_CLEAR                    "pcl"
+#define CMD_PEDALBOARD_NAME_SET                 "pn %s ..."
+#define CMD_PEDALBOARD_CHANGE                   "pchng %i"
+#define CMD_DUOX_PAGES_AVAILABLE                "pa %i %i %i %i %i %i %i %i"
+#define CMD_DUOX_SET_CONTRAST                   "sc %i %i"
+#define CMD_DUOX_EXP_OVERCURRENT                "eo"
+#define CMD_DISP_BRIGHTNESS                     "db %i"
+#define CMD_SELFTEST_SAVE_POT_CALIBRATION       "spc %i %i"
+#define CMD_SELFTEST_SKIP_CONTROL_ENABLE        "sce"
+#define CMD_SELFTEST_CHECK_CALIBRATION          "cc %i"
+#define CMD_RESET_EEPROM                        "reset_eeprom"
+#define CMD_SYS_LAUNCH_POPUP                    "sys_pop %i %i %s %s"
+#define CMD_SYS_CHANGE_LED_BLINK                "slb %i %i %i"
+#define CMD_SYS_CHANGE_LED_BRIGHTNESS           "slbr %i %i"
+#define CMD_SYS_CHANGE_NAME                     "sn %i %s"
+#define CMD_SYS_CHANGE_UNIT                     "su %i %s"
+#define CMD_SYS_CHANGE_VALUE                    "sv %i %s"
+#define CMD_SYS_CHANGE_WIDGET_INDICATOR         "sw %i %i %f"
+
+#define RESP_ERR_COMMAND_NOT_FOUND              "r -1"
+#define RESP_ERR_MANY_ARGUMENTS                 "r -2"
+#define RESP_ERR_FEW_ARGUMENTS                  "r -3"
+#define RESP_ERR_INVALID_ARGUMENT               "r -4"
+
+#define MENU_ID_TOP                             0
+#define MENU_ID_TUNER_MUTE                      1
+#define MENU_ID_QUICK_BYPASS                    2
+#define MENU_ID_MASTER_VOL_PORT                 3
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * Host port of the FreeRTOS port macros, used by the unit tests instead of the Cortex-M3 one.
+ * The interrupt masking and the yields are functions of the test doubles (mock.c).
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    uint32_t
+#define portBASE_TYPE     long
+
+typedef portSTACK_TYPE   StackType_t;
+typedef long             BaseType_t;
+typedef unsigned long    UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t         TickType_t;
+#define portMAX_DELAY    (TickType_t) 0xffff
+#else
+typedef uint32_t         TickType_t;
+#define portMAX_DELAY    (TickType_t) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC    1
+#endif
+
+#define portSTACK_GROWTH      (-1)
+#define portTICK_PERIOD_MS    ((TickType_t) 1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT    8
+#define portDONT_DISCARD      __attribute__((used))
+
+void vPortYield(void);
+uint32_t ulPortRaiseBASEPRI(void);
+void vPortSetBASEPRI(uint32_t ulNewMaskValue);
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+
+#define portYIELD()                                 vPortYield()
+#define portEND_SWITCHING_ISR(xSwitchRequired)      do { if (xSwitchRequired != pdFALSE) portYIELD(); } while (0)
+#define portYIELD_FROM_ISR(x)                       portEND_SWITCHING_ISR(x)
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()           ulPortRaiseBASEPRI()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)        vPortSetBASEPRI(x)
+#define portDISABLE_INTERRUPTS()                    (void) ulPortRaiseBASEPRI()
+#define portENABLE_INTERRUPTS()                     vPortSetBASEPRI(0)
+#define portENTER_CRITICAL()                        vPortEnterCritical()
+#define portEXIT_CRITICAL()                         vPortExitCritical()
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters)    void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters)          void vFunction(void *pvParameters)
+
+#define portNOP()
+#define portINLINE              __inline
+#define portFORCE_INLINE        inline __attribute__((always_inline))
+#define portMEMORY_BARRIER()    __asm volatile ("" ::: "memory")
+
+#endif
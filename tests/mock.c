@@ -0,0 +1,319 @@
+/*
+************************************************************************************************************************
+*           INCLUDE FILES
+************************************************************************************************************************
+*/
+
+#include "mock.h"
+#include "device.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+
+/*
+************************************************************************************************************************
+*           LOCAL DEFINES
+************************************************************************************************************************
+*/
+
+// address ranges of the peripherals: AHB (GPDMA, GPIO), APB0 and APB1, system control space (NVIC, SCB)
+#define AHB_BASE            0x20080000
+#define AHB_SIZE            0x00040000
+#define APB_BASE            0x40000000
+#define APB_SIZE            0x00100000
+#define SCS_PAGE            0xE000E000
+#define SCS_SIZE            0x00001000
+
+
+/*
+************************************************************************************************************************
+*           LOCAL DATA TYPES
+************************************************************************************************************************
+*/
+
+typedef struct MOCK_QUEUE_T {
+    uint32_t length, item_size;
+    uint32_t count, head;
+    uint8_t *items;
+} mock_queue_t;
+
+
+/*
+************************************************************************************************************************
+*           GLOBAL VARIABLES
+************************************************************************************************************************
+*/
+
+unsigned int g_test_failures;
+uint32_t g_mock_pins[MOCK_GPIO_PORTS];
+uint8_t g_mock_dma_status[MOCK_DMA_CHANNELS];
+uint8_t g_mock_dma_enabled[MOCK_DMA_CHANNELS];
+unsigned int g_mock_blocked;
+
+
+/*
+************************************************************************************************************************
+*           LOCAL FUNCTIONS
+************************************************************************************************************************
+*/
+
+static void map_range(uintptr_t base, size_t size)
+{
+    void *address = mmap((void *) base, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (address != (void *) base)
+    {
+        printf("can't map the peripherals at 0x%08lx\n", (unsigned long) base);
+        exit(2);
+    }
+}
+
+// the peripherals registers are zeroed memory from the start
+__attribute__((constructor)) static void map_peripherals(void)
+{
+    map_range(AHB_BASE, AHB_SIZE);
+    map_range(APB_BASE, APB_SIZE);
+    map_range(SCS_PAGE, SCS_SIZE);
+}
+
+
+/*
+************************************************************************************************************************
+*           GLOBAL FUNCTIONS
+************************************************************************************************************************
+*/
+
+int test_result(const char *name)
+{
+    if (g_test_failures)
+    {
+        printf("%s: %u checks failed\n", name, g_test_failures);
+        return 1;
+    }
+
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+//// FreeRTOS
+
+void *pvPortMalloc(size_t xSize)
+{
+    return malloc(xSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+uint32_t ulPortRaiseBASEPRI(void)
+{
+    return 0;
+}
+
+void vPortSetBASEPRI(uint32_t ulNewMaskValue)
+{
+    (void) ulNewMaskValue;
+}
+
+void vPortYield(void)
+{
+}
+
+// the queues never block, a task which would block gets the timeout result instead
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize,
+                                  const uint8_t ucQueueType)
+{
+    mock_queue_t *queue = calloc(1, sizeof(mock_queue_t));
+
+    (void) ucQueueType;
+
+    queue->length = uxQueueLength;
+    queue->item_size = uxItemSize;
+    queue->items = calloc(uxQueueLength, uxItemSize ? uxItemSize : 1);
+
+    return (QueueHandle_t) queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    mock_queue_t *queue = (mock_queue_t *) xQueue;
+
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue)
+{
+    mock_queue_t *queue = (mock_queue_t *) xQueue;
+
+    (void) xNewQueue;
+
+    queue->count = 0;
+    queue->head = 0;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait,
+                             const BaseType_t xCopyPosition)
+{
+    mock_queue_t *queue = (mock_queue_t *) xQueue;
+
+    (void) xTicksToWait;
+    (void) xCopyPosition;
+
+    if (queue->count == queue->length) return errQUEUE_FULL;
+
+    if (queue->item_size && pvItemToQueue)
+    {
+        uint32_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[tail * queue->item_size], pvItemToQueue, queue->item_size);
+    }
+
+    queue->count++;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueGenericSendFromISR(QueueHandle_t xQueue, const void * const pvItemToQueue,
+                                    BaseType_t * const pxHigherPriorityTaskWoken, const BaseType_t xCopyPosition)
+{
+    (void) pxHigherPriorityTaskWoken;
+
+    return xQueueGenericSend(xQueue, pvItemToQueue, 0, xCopyPosition);
+}
+
+BaseType_t xQueueGiveFromISR(QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken)
+{
+    (void) pxHigherPriorityTaskWoken;
+
+    return xQueueGenericSend(xQueue, NULL, 0, queueSEND_TO_BACK);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait)
+{
+    mock_queue_t *queue = (mock_queue_t *) xQueue;
+
+    (void) xTicksToWait;
+
+    if (queue->count == 0)
+    {
+        g_mock_blocked++;
+        return errQUEUE_EMPTY;
+    }
+
+    if (queue->item_size && pvBuffer)
+        memcpy(pvBuffer, &queue->items[queue->head * queue->item_size], queue->item_size);
+
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+
+    return pdPASS;
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait)
+{
+    return xQueueReceive(xQueue, NULL, xTicksToWait);
+}
+
+//// CDL drivers
+
+uint32_t FIO_ReadValue(uint8_t portNum)
+{
+    return g_mock_pins[portNum];
+}
+
+void GPIO_SetDir(uint8_t portNum, uint32_t bitValue, uint8_t dir)
+{
+    (void) portNum;
+    (void) bitValue;
+    (void) dir;
+}
+
+void GPIO_SetValue(uint8_t portNum, uint32_t bitValue)
+{
+    g_mock_pins[portNum] |= bitValue;
+}
+
+void GPIO_ClearValue(uint8_t portNum, uint32_t bitValue)
+{
+    g_mock_pins[portNum] &= ~bitValue;
+}
+
+PINSEL_RET_CODE PINSEL_SetPinFunc(uint8_t portnum, uint8_t pinnum, uint8_t funcnum)
+{
+    (void) portnum;
+    (void) pinnum;
+    (void) funcnum;
+
+    return PINSEL_RET_OK;
+}
+
+void GPDMA_Init(void)
+{
+    LPC_SC->PCONP |= CLKPWR_PCONP_PCGPDMA;
+}
+
+// programs the channel registers as the CDL does, the peripheral addresses are left as zero
+Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
+{
+    uint32_t ch = GPDMAChannelConfig->ChannelNum;
+    LPC_GPDMACH_TypeDef *channel = (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (ch * 0x20));
+
+    if (g_mock_dma_enabled[ch]) return ERROR;
+
+    g_mock_dma_status[ch] = 0;
+
+    channel->CLLI = GPDMAChannelConfig->DMALLI;
+    channel->CSrcAddr = GPDMAChannelConfig->SrcMemAddr;
+    channel->CDestAddr = GPDMAChannelConfig->DstMemAddr;
+    channel->CControl = GPDMA_DMACCxControl_TransferSize(GPDMAChannelConfig->TransferSize) |
+                        GPDMA_DMACCxControl_I;
+
+    return SUCCESS;
+}
+
+IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel)
+{
+    switch (type)
+    {
+        case GPDMA_STAT_INT:
+            return g_mock_dma_status[channel] ? SET : RESET;
+        case GPDMA_STAT_INTTC:
+        case GPDMA_STAT_RAWINTTC:
+            return (g_mock_dma_status[channel] & 1) ? SET : RESET;
+        case GPDMA_STAT_INTERR:
+        case GPDMA_STAT_RAWINTERR:
+            return (g_mock_dma_status[channel] & 2) ? SET : RESET;
+        case GPDMA_STAT_ENABLED_CH:
+            return g_mock_dma_enabled[channel] ? SET : RESET;
+    }
+
+    return RESET;
+}
+
+void GPDMA_ClearIntPending(GPDMA_StateClear_Type type, uint8_t channel)
+{
+    g_mock_dma_status[channel] &= (type == GPDMA_STATCLR_INTTC) ? ~1 : ~2;
+}
+
+void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState)
+{
+    g_mock_dma_enabled[channelNum] = (NewState == ENABLE);
+}
@@ -0,0 +1,96 @@
+/*
+ * Host doubles of the hardware and of the FreeRTOS kernel used by the firmware modules under test,
+ * and the checks of the unit tests.
+ *
+ * The peripherals are plain memory mapped at their addresses, so the modules read and write their
+ * registers as usual and the tests play the role of the hardware on them.
+ */
+
+#ifndef MOCK_H
+#define MOCK_H
+
+
+/*
+************************************************************************************************************************
+*           INCLUDE FILES
+************************************************************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+/*
+************************************************************************************************************************
+*           CONFIGURATION DEFINES
+************************************************************************************************************************
+*/
+
+#define MOCK_GPIO_PORTS         6
+#define MOCK_DMA_CHANNELS       8
+
+
+/*
+************************************************************************************************************************
+*           GLOBAL VARIABLES
+************************************************************************************************************************
+*/
+
+extern unsigned int g_test_failures;
+
+// pins levels returned by FIO_ReadValue
+extern uint32_t g_mock_pins[MOCK_GPIO_PORTS];
+
+// interrupt status of the DMA channels (bit 0 terminal count, bit 1 error) and whether they are enabled
+extern uint8_t g_mock_dma_status[MOCK_DMA_CHANNELS];
+extern uint8_t g_mock_dma_enabled[MOCK_DMA_CHANNELS];
+
+// times a task would have blocked on an empty queue or semaphore
+extern unsigned int g_mock_blocked;
+
+
+/*
+************************************************************************************************************************
+*           MACRO'S
+************************************************************************************************************************
+*/
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            g_test_failures++;                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);         \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQUAL(value, expected)                                                \
+    do {                                                                            \
+        long long _value = (long long) (value), _expected = (long long) (expected); \
+        if (_value != _expected) {                                                  \
+            g_test_failures++;                                                      \
+            printf("%s:%d: check failed: %s is %lld, expected %lld\n",             \
+                   __FILE__, __LINE__, #value, _value, _expected);                  \
+        }                                                                           \
+    } while (0)
+
+// pointers the modules keep in 32 bits registers, the tests are linked as non PIE so they fit
+#define MOCK_ADDRESS(address)   ((void *) (uintptr_t) (address))
+
+
+/*
+************************************************************************************************************************
+*           FUNCTION PROTOTYPES
+************************************************************************************************************************
+*/
+
+// prints the result of the test and returns its exit status
+int test_result(const char *name);
+
+
+/*
+************************************************************************************************************************
+*           END HEADER
+************************************************************************************************************************
+*/
+
+#endif
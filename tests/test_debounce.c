@@ -0,0 +1,224 @@
+/*
+ * debounce: the vertical counters of a whole port against a reference model debouncing each bit on its
+ * own, with synthetic bounce waveforms
+ */
+
+#include "mock.h"
+#include "debounce.h"
+
+#include <stdlib.h>
+
+#define RANDOM_TRIALS       100
+#define TRIAL_CLOCKS        20000
+
+// debounce of a single bit, counting down the clocks the input stays out of the debounced state
+typedef struct REFERENCE_T {
+    uint8_t used, state;
+    uint16_t press_time, release_time, hold_time;
+    uint16_t counter, hold_counter;
+} reference_t;
+
+static void reference_add(reference_t *ref, uint16_t press_time, uint16_t release_time, uint16_t hold_time)
+{
+    ref->used = 1;
+    ref->state = 0;
+    ref->press_time = press_time;
+    ref->release_time = release_time;
+    ref->hold_time = hold_time;
+    ref->counter = press_time;
+    ref->hold_counter = 0;
+}
+
+// returns the edges of the clock: bit 0 pressed, bit 1 released, bit 2 held
+static uint8_t reference_clock(reference_t *ref, uint8_t active)
+{
+    if (active == ref->state)
+    {
+        // a bounce back restarts the debounce
+        ref->counter = ref->state ? ref->release_time : ref->press_time;
+
+        if (ref->state && ref->hold_counter > 0 && --ref->hold_counter == 0)
+            return 4;
+
+        return 0;
+    }
+
+    if (--ref->counter > 0)
+        return 0;
+
+    ref->state = active;
+    if (active)
+    {
+        ref->counter = ref->release_time;
+        ref->hold_counter = ref->hold_time;
+        return 1;
+    }
+
+    ref->counter = ref->press_time;
+    ref->hold_counter = 0;
+    return 2;
+}
+
+static uint8_t edges(const debounce_t *db, uint8_t bit)
+{
+    return ((db->pressed >> bit) & 1) | (((db->released >> bit) & 1) << 1) | (((db->held >> bit) & 1) << 2);
+}
+
+// clocks the same input count times, returns the clocks until the first edge of bit (count if none)
+static uint32_t clock_until_edge(debounce_t *db, uint32_t active, uint32_t count, uint8_t bit)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        debounce_clock(db, active);
+        if (edges(db, bit)) return i + 1;
+    }
+
+    return count;
+}
+
+static void test_reference(void)
+{
+    debounce_t db;
+    reference_t refs[32];
+    uint32_t trial, t, active, flip;
+    uint16_t press_time, release_time, hold_time;
+    uint8_t bit;
+
+    srand(7);
+
+    for (trial = 0; trial < RANDOM_TRIALS && !g_test_failures; trial++)
+    {
+        debounce_init(&db);
+
+        // a random set of the bits with random times, the last bit of the port is always one of them
+        for (bit = 0; bit < 32; bit++)
+        {
+            refs[bit].used = 0;
+            if (bit != 31 && (rand() % 3) == 0) continue;
+
+            press_time = 1 + rand() % 100;
+            release_time = 1 + rand() % 120;
+            hold_time = (rand() % 3) ? rand() % 600 : 0;
+
+            debounce_add(&db, bit, press_time, release_time);
+            debounce_set_hold(&db, bit, hold_time);
+            reference_add(&refs[bit], press_time, release_time, hold_time);
+        }
+
+        // the bits flip now and then, with bursts of bounces moving from bit to bit
+        active = 0;
+        for (t = 0; t < TRIAL_CLOCKS && !g_test_failures; t++)
+        {
+            for (bit = 0; bit < 32; bit++)
+            {
+                flip = (((t / 700) + bit) % 4 == 0) ? 300 : 3;
+                if ((uint32_t) (rand() % 1000) < flip) active ^= (1UL << bit);
+            }
+
+            debounce_clock(&db, active);
+
+            for (bit = 0; bit < 32; bit++)
+            {
+                if (refs[bit].used) CHECK_EQUAL(edges(&db, bit), reference_clock(&refs[bit], (active >> bit) & 1));
+                else CHECK_EQUAL(edges(&db, bit), 0);
+            }
+
+            CHECK_EQUAL(db.state & ~db.mask, 0);
+        }
+    }
+}
+
+static void test_bounce(void)
+{
+    debounce_t db;
+    uint32_t i;
+
+    debounce_init(&db);
+    debounce_add(&db, 31, 10, 20);
+    debounce_add(&db, 4, 10, 20);
+
+    // a contact bouncing for a while is pressed once, the time after it stops bouncing
+    for (i = 0; i < 30; i++)
+    {
+        debounce_clock(&db, ((i % 3) != 2 ? 1UL : 0) << 31);
+        CHECK_EQUAL(db.pressed, 0);
+    }
+
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 100, 31), 10);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(db.state, 1UL << 31);
+
+    // and released once, after the release time
+    for (i = 0; i < 30; i++)
+    {
+        debounce_clock(&db, ((i % 4) == 1 ? 1UL : 0) << 31);
+        CHECK_EQUAL(db.released, 0);
+    }
+
+    CHECK_EQUAL(clock_until_edge(&db, 0, 100, 31), 20);
+    CHECK_EQUAL(db.released, 1UL << 31);
+    CHECK_EQUAL(db.state, 0);
+
+    // the bits of the port are debounced together, each with its own counter
+    clock_until_edge(&db, 1UL << 31, 5, 31);
+    CHECK_EQUAL(clock_until_edge(&db, (1UL << 31) | (1 << 4), 100, 31), 5);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(clock_until_edge(&db, (1UL << 31) | (1 << 4), 100, 4), 5);
+    CHECK_EQUAL(db.pressed, 1 << 4);
+}
+
+static void test_hold(void)
+{
+    debounce_t db;
+    uint32_t i;
+
+    debounce_init(&db);
+    debounce_add(&db, 31, 1, 1);
+    debounce_set_hold(&db, 31, 100);
+
+    // a press released before the hold time doesn't hold
+    clock_until_edge(&db, 1UL << 31, 1, 31);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 90, 31), 90);
+    clock_until_edge(&db, 0, 1, 31);
+    CHECK_EQUAL(db.released, 1UL << 31);
+
+    // and the next press always reloads the hold time, the hold comes the whole time after it
+    clock_until_edge(&db, 1UL << 31, 1, 31);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 200, 31), 100);
+    CHECK_EQUAL(db.held, 1UL << 31);
+
+    // the hold comes once per press, even past the range of the hold counter
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 2 << DEBOUNCE_HOLD_BITS, 31), 2 << DEBOUNCE_HOLD_BITS);
+
+    clock_until_edge(&db, 0, 1, 31);
+    CHECK_EQUAL(db.released, 1UL << 31);
+
+    // so does a press after a hold, with the hold time changed while released
+    debounce_set_hold(&db, 31, 30);
+    for (i = 0; i < 10; i++) debounce_clock(&db, 0);
+
+    clock_until_edge(&db, 1UL << 31, 1, 31);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 200, 31), 30);
+    CHECK_EQUAL(db.held, 1UL << 31);
+    clock_until_edge(&db, 0, 1, 31);
+
+    // without a hold time the press never holds
+    debounce_set_hold(&db, 31, 0);
+    clock_until_edge(&db, 1UL << 31, 1, 31);
+    CHECK_EQUAL(db.pressed, 1UL << 31);
+    CHECK_EQUAL(clock_until_edge(&db, 1UL << 31, 10000, 31), 10000);
+}
+
+int main(void)
+{
+    test_reference();
+    test_bounce();
+    test_hold();
+
+    return test_result("debounce");
+}
@@ -0,0 +1,318 @@
+/*
+ * actuator: encoders detents, accumulated by the actuators clock until the application takes them,
+ * decoded from the A/B pin sequences by the steps table and accelerated by the time between them
+ */
+
+#include "mock.h"
+#include "actuator.h"
+#include "hardware.h"
+
+// the encoder button is on bit 0 of port 0, the channels A and B on bits 1 and 2,
+// the second encoder uses the same bits of port 1
+#define PORT        0
+#define PORT2       1
+#define BUTTON_PIN  0
+#define CHA_PIN     1
+#define CHB_PIN     2
+
+static const uint8_t ENCODER_PINS[] = {PORT, BUTTON_PIN, PORT, CHA_PIN, PORT, CHB_PIN};
+static const uint8_t ENCODER2_PINS[] = {PORT2, BUTTON_PIN, PORT2, CHA_PIN, PORT2, CHB_PIN};
+
+// A and B levels of a clockwise detent, it starts and ends with both low
+static const uint8_t CW_SEQUENCE[4][2] = {{1, 0}, {1, 1}, {0, 1}, {0, 0}};
+
+static encoder_t g_encoder, g_encoder2;
+static button_t g_button;
+static uint32_t g_timestamp;
+static uint32_t g_pots_sums[8];
+static int g_events, g_cw_events, g_acw_events;
+
+uint32_t hardware_timestamp(void)
+{
+    return g_timestamp;
+}
+
+const volatile uint32_t *hardware_pots_sums(void)
+{
+    return g_pots_sums;
+}
+
+// the trigger flags are seen by the event and cleared after it
+static void encoder_event(void *actuator)
+{
+    uint8_t status = actuator_get_status(actuator);
+
+    g_events++;
+    if (ENCODER_TURNED_CW(status)) g_cw_events++;
+    if (ENCODER_TURNED_ACW(status)) g_acw_events++;
+}
+
+static void set_port_channels(uint8_t port, uint8_t a, uint8_t b)
+{
+    g_mock_pins[port] &= ~((1 << CHA_PIN) | (1 << CHB_PIN));
+    g_mock_pins[port] |= (a << CHA_PIN) | (b << CHB_PIN);
+}
+
+static void set_channels(uint8_t a, uint8_t b)
+{
+    set_port_channels(PORT, a, b);
+}
+
+static void clock(uint32_t clocks)
+{
+    while (clocks--)
+    {
+        actuators_clock();
+        g_timestamp++;
+    }
+}
+
+// turns the encoder of the port the detents (negative is anticlockwise) with the clocks between the
+// channel edges, each edge bounces back the times given before it settles
+static void turn_port(uint8_t port, int detents, uint32_t clocks_per_edge, uint32_t bounces)
+{
+    int cw = detents > 0;
+    int count = cw ? detents : -detents;
+    const uint8_t *ab, *previous;
+    uint32_t k;
+    int i, j;
+
+    for (i = 0; i < count; i++)
+    {
+        for (j = 0; j < 4; j++)
+        {
+            // anticlockwise is the same sequence backwards
+            ab = cw ? CW_SEQUENCE[j] : CW_SEQUENCE[(2 - j) & 3];
+            previous = cw ? CW_SEQUENCE[(j + 3) & 3] : CW_SEQUENCE[(3 - j) & 3];
+
+            for (k = 0; k < bounces; k++)
+            {
+                set_port_channels(port, ab[0], ab[1]);
+                clock(1);
+                set_port_channels(port, previous[0], previous[1]);
+                clock(1);
+            }
+
+            set_port_channels(port, ab[0], ab[1]);
+            clock(clocks_per_edge);
+        }
+    }
+}
+
+static void turn(int detents, uint32_t clocks_per_edge)
+{
+    turn_port(PORT, detents, clocks_per_edge, 0);
+}
+
+// position of the A/B levels along the clockwise sequence
+static int sequence_position(uint8_t a, uint8_t b)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        if (CW_SEQUENCE[i][0] == a && CW_SEQUENCE[i][1] == b) return i;
+
+    return -1;
+}
+
+static void test_accumulation(void)
+{
+    g_events = 0;
+
+    turn(3, 2);
+    CHECK_EQUAL(g_events, 3);
+    CHECK_EQUAL(g_cw_events, 3);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 3);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 0);
+
+    turn(-2, 2);
+    CHECK_EQUAL(g_acw_events, 2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), -2);
+
+    // the detents not taken yet add up with their direction
+    turn(5, 2);
+    turn(-2, 2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 3);
+
+    // a partial detent is not counted
+    set_channels(1, 0);
+    clock(2);
+    set_channels(0, 0);
+    clock(2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 0);
+}
+
+static void test_saturation(void)
+{
+    turn(200, 1);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), INT8_MAX);
+
+    turn(-200, 1);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), INT8_MIN);
+
+    // only encoders have detents
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_button), 0);
+}
+
+static void test_table(void)
+{
+    uint8_t previous, current;
+    int distance;
+
+    // no detent is completed, the counter shows the step of each transition
+    actuator_set_prop(&g_encoder, ENCODER_STEPS, 100);
+
+    for (previous = 0; previous < 4; previous++)
+    {
+        for (current = 0; current < 4; current++)
+        {
+            g_encoder.state = previous;
+            g_encoder.counter = 0;
+            set_channels(current & 1, current >> 1);
+            clock(1);
+
+            // a step forward is clockwise, a step back anticlockwise, and a missed level is two steps
+            distance = (sequence_position(current & 1, current >> 1) -
+                        sequence_position(previous & 1, previous >> 1)) & 3;
+
+            if (distance == 0) CHECK_EQUAL(g_encoder.counter, 0);
+            else if (distance == 1) CHECK_EQUAL(g_encoder.counter, 1);
+            else if (distance == 3) CHECK_EQUAL(g_encoder.counter, -1);
+            else CHECK(g_encoder.counter == 2 || g_encoder.counter == -2);
+
+            CHECK_EQUAL(g_encoder.state, current);
+        }
+    }
+
+    actuator_set_prop(&g_encoder, ENCODER_STEPS, 4);
+
+    set_channels(0, 0);
+    clock(1);
+    g_encoder.counter = 0;
+    actuator_encoder_take_delta(&g_encoder);
+}
+
+static void test_bounce(void)
+{
+    // the bounces of a channel step back and forth, so each detent still counts once
+    g_cw_events = g_acw_events = 0;
+
+    turn_port(PORT, 10, 3, 3);
+    CHECK_EQUAL(g_cw_events, 10);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 10);
+
+    turn_port(PORT, -7, 3, 2);
+    CHECK_EQUAL(g_acw_events, 7);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), -7);
+
+    // and turning back halfway through a detent returns to it, the next detent still comes when both
+    // channels are back low
+    set_channels(1, 0);
+    clock(2);
+    set_channels(1, 1);
+    clock(2);
+    set_channels(1, 0);
+    clock(2);
+    set_channels(0, 0);
+    clock(2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 0);
+
+    set_channels(0, 1);
+    clock(2);
+    set_channels(1, 1);
+    clock(2);
+    set_channels(1, 0);
+    clock(2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), 0);
+    set_channels(0, 0);
+    clock(2);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder), -1);
+}
+
+static void test_acceleration(void)
+{
+    // a detent every interval clocks, the acceleration settles on the level of the interval:
+    // x detents within the window is a detent every window / x clocks
+    static const struct {
+        uint32_t interval;
+        uint8_t acceleration;
+    } levels[] = {
+        {120, 1},
+        {60, 1},
+        {28, 3},
+        {16, 5},
+        {8, 7},
+    };
+    uint32_t i;
+
+    for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+    {
+        // after a pause the encoder starts over without acceleration
+        clock(ENCODER_ACCEL_WINDOW);
+        turn(1, levels[i].interval / 4);
+        CHECK_EQUAL(g_encoder.acceleration, 1);
+
+        turn(20, levels[i].interval / 4);
+        CHECK_EQUAL(g_encoder.acceleration, levels[i].acceleration);
+        CHECK_EQUAL(actuator_get_acceleration(), levels[i].acceleration);
+    }
+
+    // the smoothed interval ramps the acceleration up over a few detents
+    clock(ENCODER_ACCEL_WINDOW);
+    turn(1, 2);
+    CHECK_EQUAL(g_encoder.acceleration, 1);
+    turn(4, 2);
+    CHECK_EQUAL(g_encoder.acceleration, 1);
+    turn(1, 2);
+    CHECK_EQUAL(g_encoder.acceleration, 3);
+    turn(3, 2);
+    CHECK_EQUAL(g_encoder.acceleration, 5);
+    turn(2, 2);
+    CHECK_EQUAL(g_encoder.acceleration, 7);
+
+    // each encoder accelerates on its own, the application gets the one of the last turned
+    clock(ENCODER_ACCEL_WINDOW);
+    turn(1, 30);
+    CHECK_EQUAL(g_encoder.acceleration, 1);
+
+    turn_port(PORT2, 20, 2, 0);
+    CHECK_EQUAL(g_encoder2.acceleration, 7);
+    CHECK_EQUAL(actuator_get_acceleration(), 7);
+    CHECK_EQUAL(actuator_encoder_take_delta(&g_encoder2), 20);
+
+    turn(1, 30);
+    CHECK_EQUAL(g_encoder.acceleration, 1);
+    CHECK_EQUAL(actuator_get_acceleration(), 1);
+    CHECK_EQUAL(g_encoder2.acceleration, 7);
+
+    actuator_encoder_take_delta(&g_encoder);
+}
+
+int main(void)
+{
+    // the buttons are active low, they're left released
+    g_mock_pins[PORT] = (1 << BUTTON_PIN);
+    g_mock_pins[PORT2] = (1 << BUTTON_PIN);
+
+    actuator_create(ROTARY_ENCODER, 0, &g_encoder);
+    actuator_set_pins(&g_encoder, ENCODER_PINS);
+    actuator_set_prop(&g_encoder, ENCODER_STEPS, 4);
+    actuator_enable_event(&g_encoder, EV_ALL_ENCODER_EVENTS);
+    actuator_set_event(&g_encoder, encoder_event);
+
+    actuator_create(ROTARY_ENCODER, 1, &g_encoder2);
+    actuator_set_pins(&g_encoder2, ENCODER2_PINS);
+    actuator_set_prop(&g_encoder2, ENCODER_STEPS, 4);
+
+    actuator_create(BUTTON, 2, &g_button);
+
+    clock(10);
+
+    test_accumulation();
+    test_saturation();
+    test_table();
+    test_bounce();
+    test_acceleration();
+
+    return test_result("encoder");
+}
@@ -0,0 +1,314 @@
+/*
+ * actuator: fixed point smoothing of the pots, checked against the same filter in floating point
+ *
+ * the ADC traces are generated: the oversampled sum of the pot position plus gaussian noise
+ */
+
+#include "mock.h"
+#include "actuator.h"
+#include "hardware.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define CHANNEL         0
+#define OVERSAMPLING    (1 << POT_OVERSAMPLING_SHIFT)
+#define ADC_MAX         4095
+
+// the filter state is the oversampled sum with 8 fraction bits
+#define STATE_TO_ADC(state)     ((state) / (256.0 * OVERSAMPLING))
+
+static const uint8_t POT_PINS[] = {0, 23, 1, CHANNEL};
+
+static pot_t g_pot;
+static uint32_t g_pots_sums[8];
+static uint32_t g_timestamp;
+static uint32_t g_events;
+
+uint32_t hardware_timestamp(void)
+{
+    return g_timestamp;
+}
+
+const volatile uint32_t *hardware_pots_sums(void)
+{
+    return g_pots_sums;
+}
+
+static void pot_event(void *actuator)
+{
+    (void) actuator;
+    g_events++;
+}
+
+static double gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+// the sum of the conversions of a tick for the pot at position with noise (in LSB)
+static uint32_t adc_sum(double position, double noise)
+{
+    uint32_t i, sum = 0;
+    double sample;
+
+    for (i = 0; i < OVERSAMPLING; i++)
+    {
+        sample = position + noise * gauss();
+        if (sample < 0) sample = 0;
+        if (sample > ADC_MAX) sample = ADC_MAX;
+        sum += (uint32_t) lround(sample);
+    }
+
+    return sum;
+}
+
+static void tick(uint32_t sum)
+{
+    g_pots_sums[CHANNEL] = sum | HARDWARE_POT_SUM_VALID;
+    actuators_clock();
+    g_timestamp++;
+}
+
+// the pot is registered once, then each test starts its filter over
+static void pot_start(uint8_t min_cutoff, uint8_t beta)
+{
+    static uint8_t created;
+
+    if (!created)
+    {
+        actuator_create(POT, 0, &g_pot);
+        actuator_set_pins(&g_pot, POT_PINS);
+        actuator_enable_event(&g_pot, EV_POT_TURNED);
+        actuator_set_event(&g_pot, pot_event);
+        created = 1;
+    }
+
+    g_pot.value = 0;
+    g_pot.speed = 0;
+    g_pot.filter_init = 0;
+
+    actuator_set_prop(&g_pot, POT_MIN_CUTOFF, min_cutoff);
+    actuator_set_prop(&g_pot, POT_BETA, beta);
+}
+
+// the pot starts over at position, the filter is seeded by its first reading
+static void pot_reset(uint8_t min_cutoff, uint8_t beta, double position)
+{
+    pot_start(min_cutoff, beta);
+
+    tick(adc_sum(position, 0));
+    g_events = 0;
+}
+
+// the filtered value the pot reports, rounded to the ADC resolution
+static uint16_t filtered_value(void)
+{
+    return (g_pot.filtered + (1 << (8 + POT_OVERSAMPLING_SHIFT - 1))) >> (8 + POT_OVERSAMPLING_SHIFT);
+}
+
+static void test_reference(void)
+{
+    // without speed the pot is a first order low pass at the min cutoff, the reference takes the
+    // coefficient in Q16 as the pot does, which is within 1% of the one of the nominal cutoff
+    const uint8_t min_cutoff = DEFAULT_POT_MIN_CUTOFF;
+    const double w = 2.0 * M_PI * (min_cutoff * 0.1) * (CLOCK_PERIOD * 0.001);
+    const uint32_t w_q16 = min_cutoff * 41 * CLOCK_PERIOD;
+    const double alpha = (0x10000 - (0xFFFFFFFF / (w_q16 + 0x10000))) / 65536.0;
+
+    double reference, position, error, max_error = 0;
+    uint32_t t, sum;
+
+    CHECK(fabs(alpha / (w / (1.0 + w)) - 1.0) < 0.01);
+
+    srand(1);
+    pot_reset(min_cutoff, 0, 1000);
+    reference = 1000 * OVERSAMPLING;
+
+    // steps, ramps and noise, the fixed point filter stays within the tenth of a LSB the truncation
+    // of its state can leave behind
+    for (t = 0; t < 20000; t++)
+    {
+        if (t < 4000) position = 1000;
+        else if (t < 8000) position = 3000;
+        else if (t < 14000) position = 3000 - (t - 8000) * 0.4;
+        else position = 600 + 200 * sin(t * 0.002);
+
+        sum = adc_sum(position, 3.0);
+        tick(sum);
+        reference += alpha * (sum - reference);
+
+        error = fabs(STATE_TO_ADC(g_pot.filtered) - reference / OVERSAMPLING);
+        if (error > max_error) max_error = error;
+    }
+
+    CHECK(max_error < 0.1);
+}
+
+static void test_model(void)
+{
+    // with speed the pot is the 1 euro filter, the reference runs it in floating point with the nominal
+    // constants: the speed smoothed the same way and taken per second over the clock period
+    const uint8_t min_cutoff = DEFAULT_POT_MIN_CUTOFF, beta = DEFAULT_POT_BETA;
+    const double period = CLOCK_PERIOD * 0.001;
+    const double speed_scale = (1 << POT_SPEED_SHIFT) * OVERSAMPLING * period;
+
+    double reference, speed = 0, last, cutoff, w, position, error, max_error = 0;
+    uint32_t t, sum;
+
+    srand(4);
+    pot_reset(min_cutoff, beta, 1000);
+    reference = last = 1000 * OVERSAMPLING;
+
+    // rest, a step, ramps of a slow and a fast move and a sweep back and forth
+    for (t = 0; t < 20000; t++)
+    {
+        if (t < 2000) position = 1000;
+        else if (t < 4000) position = 1400;
+        else if (t < 9000) position = 1400 + (t - 4000) * 0.2;
+        else if (t < 9250) position = 2400 + (t - 9000) * 6.0;
+        else if (t < 12000) position = 3900;
+        else position = 2000 + 1500 * sin((t - 12000) * 0.003);
+
+        sum = adc_sum(position, 2.0);
+        tick(sum);
+
+        speed += (sum - last) - speed / (1 << POT_SPEED_SHIFT);
+        last = sum;
+
+        cutoff = (min_cutoff * 0.1) + (beta * 0.001) * (fabs(speed) / speed_scale);
+        w = 2.0 * M_PI * cutoff * period;
+        reference += (w / (1.0 + w)) * (sum - reference);
+
+        error = fabs(STATE_TO_ADC(g_pot.filtered) - reference / OVERSAMPLING);
+        if (error > max_error) max_error = error;
+    }
+
+    // the Q16 scales and the truncation of the speed keep the fixed point filter within half a LSB
+    CHECK(max_error < 0.5);
+}
+
+static void test_rest(void)
+{
+    uint32_t t;
+
+    // a pot at rest with the noise of the ADC never reports a change
+    srand(2);
+    pot_reset(DEFAULT_POT_MIN_CUTOFF, DEFAULT_POT_BETA, 2000);
+
+    for (t = 0; t < 60000; t++)
+        tick(adc_sum(2000, 2.0));
+
+    CHECK_EQUAL(g_events, 0);
+}
+
+static void test_convergence(void)
+{
+    uint32_t t;
+
+    // after a step the filter settles exactly on the new value, and the value reported follows it
+    pot_reset(DEFAULT_POT_MIN_CUTOFF, DEFAULT_POT_BETA, 1000);
+
+    for (t = 0; t < 10000; t++)
+        tick(adc_sum(3000, 0));
+
+    CHECK_EQUAL(filtered_value(), 3000);
+    CHECK(abs((int) actuator_pot_value(0) - 3000) <= POT_THRESHOLD);
+    CHECK(g_events > 0);
+
+    // the fraction bits keep a single LSB step from being lost in the state, which settles within
+    // a tenth of a LSB
+    for (t = 0; t < 10000; t++)
+        tick(adc_sum(3001, 0));
+
+    CHECK_EQUAL(filtered_value(), 3001);
+    CHECK(fabs(STATE_TO_ADC(g_pot.filtered) - 3001) < 0.1);
+
+    // and so do the ends of the range
+    for (t = 0; t < 10000; t++)
+        tick(adc_sum(ADC_MAX, 0));
+
+    CHECK_EQUAL(filtered_value(), ADC_MAX);
+
+    for (t = 0; t < 10000; t++)
+        tick(adc_sum(0, 0));
+
+    CHECK_EQUAL(filtered_value(), 0);
+}
+
+static void test_seed(void)
+{
+    uint32_t t;
+
+    // the first reading seeds the filter, the pot reports its position at once instead of ramping to it
+    pot_start(DEFAULT_POT_MIN_CUTOFF, DEFAULT_POT_BETA);
+    g_events = 0;
+
+    // nothing is read until the DMA publishes a complete sum
+    g_pots_sums[CHANNEL] = 0;
+    actuators_clock();
+    CHECK_EQUAL(g_events, 0);
+
+    tick(adc_sum(2500, 0));
+    CHECK_EQUAL(g_events, 1);
+    CHECK_EQUAL(actuator_pot_value(0), 2500);
+
+    for (t = 0; t < 1000; t++)
+        tick(adc_sum(2500, 0));
+
+    CHECK_EQUAL(g_events, 1);
+}
+
+// the largest distance between the position and the value reported along a ramp
+static double ramp_lag(uint8_t beta, double speed)
+{
+    double position = 500, lag, max_lag = 0;
+
+    srand(3);
+    pot_reset(DEFAULT_POT_MIN_CUTOFF, beta, position);
+
+    while (position < 3500)
+    {
+        position += speed;
+        tick(adc_sum(position, 2.0));
+
+        lag = position - actuator_pot_value(0);
+        if (lag > max_lag) max_lag = lag;
+    }
+
+    return max_lag;
+}
+
+static void test_speed(void)
+{
+    double lag, fixed_lag;
+
+    // the cutoff rises with the speed: a fast move lags a fraction of what the min cutoff alone gives
+    fixed_lag = ramp_lag(0, 8.0);
+    lag = ramp_lag(DEFAULT_POT_BETA, 8.0);
+    CHECK(lag < fixed_lag / 10);
+
+    // while a slow move stays smooth, it lags about as much as with the min cutoff alone
+    fixed_lag = ramp_lag(0, 0.2);
+    lag = ramp_lag(DEFAULT_POT_BETA, 0.2);
+    CHECK(lag <= fixed_lag);
+    CHECK(lag > POT_THRESHOLD);
+
+    // the beta is tuned per pot, a larger one follows faster
+    CHECK(ramp_lag(4 * DEFAULT_POT_BETA, 8.0) < ramp_lag(DEFAULT_POT_BETA, 8.0));
+}
+
+int main(void)
+{
+    test_reference();
+    test_model();
+    test_rest();
+    test_convergence();
+    test_seed();
+    test_speed();
+
+    return test_result("pots");
+}
@@ -0,0 +1,205 @@
+/*
+ * hardware: the DMA interrupt sums the half of the ADC samples buffer just filled and publishes the
+ * sums of the last conversions of each channel
+ *
+ * the test plays the DMA controller: it writes the global data register words of the burst at the
+ * destination address and follows the linked list items at the end of each half
+ */
+
+#include "mock.h"
+
+// the module is included to reach the samples buffer and the start of the DMA
+#include "../app/src/hardware.c"
+
+#define HALF_SAMPLES    (POTS_SAMPLES / 2)
+#define OVERSAMPLING    (1 << POT_OVERSAMPLING_SHIFT)
+
+// the conversion words as the ADC writes them to the global data register
+#define GDR_WORD(ch,value)      (ADC_GDR_DONE_FLAG | ((uint32_t) (ch) << 24) | ((uint32_t) (value) << 4))
+
+static LPC_GPDMACH_TypeDef *g_channel;
+static uint32_t g_remaining;
+
+// conversions done of each channel, the value of a conversion is a function of the channel and of its count
+static uint32_t g_conversions[ADC_CHANNELS_COUNT];
+static uint32_t g_serial_handler_calls;
+
+void serial_dma_handler(void)
+{
+    g_serial_handler_calls++;
+}
+
+void ADC_IntConfig(LPC_ADC_TypeDef *ADCx, ADC_TYPE_INT_OPT IntType, FunctionalState NewState)
+{
+    (void) ADCx;
+    (void) IntType;
+    (void) NewState;
+}
+
+static uint16_t conversion_value(uint8_t ch, uint32_t count)
+{
+    return (ch * 500 + count * 7) & 0xFFF;
+}
+
+// the sum the interrupt must publish for the channel: its last conversions
+static uint32_t expected_sum(uint8_t ch)
+{
+    uint32_t i, sum = 0;
+
+    for (i = g_conversions[ch] - OVERSAMPLING; i < g_conversions[ch]; i++)
+        sum += conversion_value(ch, i);
+
+    return sum;
+}
+
+// the DMA writes a word, at the end of the transfer it loads the next item and raises the interrupt
+static void dma_write(uint32_t word)
+{
+    const GPDMA_LLI_Type *lli;
+
+    *(volatile uint32_t *) MOCK_ADDRESS(g_channel->CDestAddr) = word;
+    g_channel->CDestAddr += sizeof(uint32_t);
+
+    if (--g_remaining == 0)
+    {
+        lli = MOCK_ADDRESS(g_channel->CLLI);
+        g_channel->CSrcAddr = lli->SrcAddr;
+        g_channel->CDestAddr = lli->DstAddr;
+        g_channel->CLLI = lli->NextLLI;
+        g_channel->CControl = lli->Control;
+        g_remaining = HALF_SAMPLES;
+
+        g_mock_dma_status[POTS_DMA_CHANNEL] |= 1;
+        DMA_IRQHandler();
+    }
+}
+
+// the burst converts the channels one after the other starting at first
+static void burst(uint8_t first, uint32_t words)
+{
+    uint8_t ch = first;
+
+    while (words--)
+    {
+        dma_write(GDR_WORD(ch, conversion_value(ch, g_conversions[ch])));
+        g_conversions[ch]++;
+        ch = (ch + 1) % ADC_CHANNELS_COUNT;
+    }
+}
+
+static void check_sums(void)
+{
+    const volatile uint32_t *sums = hardware_pots_sums();
+    uint8_t ch;
+
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+        CHECK_EQUAL(sums[ch], expected_sum(ch) | HARDWARE_POT_SUM_VALID);
+}
+
+static void test_start(void)
+{
+    const volatile uint32_t *sums = hardware_pots_sums();
+    uint8_t ch;
+
+    pots_dma_start();
+
+    g_channel = (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (POTS_DMA_CHANNEL * 0x20));
+    g_remaining = HALF_SAMPLES;
+
+    CHECK(LPC_SC->PCONP & CLKPWR_PCONP_PCGPDMA);
+    CHECK(g_mock_dma_enabled[POTS_DMA_CHANNEL]);
+    CHECK(NVIC->ISER[0] & (1 << DMA_IRQn));
+    CHECK_EQUAL(g_channel->CDestAddr, (uint32_t) g_pots_samples);
+
+    // the first half doesn't hold enough conversions of any channel yet
+    burst(0, HALF_SAMPLES);
+    CHECK_EQUAL(g_serial_handler_calls, 1);
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+        CHECK(!(sums[ch] & HARDWARE_POT_SUM_VALID));
+
+    // the whole buffer does
+    burst(0, HALF_SAMPLES);
+    CHECK_EQUAL(g_channel->CDestAddr, (uint32_t) g_pots_samples);
+    check_sums();
+}
+
+static void test_halves(void)
+{
+    uint32_t i;
+
+    // each half replaces the older conversions of the sums, whichever half the DMA is writing
+    for (i = 0; i < 9; i++)
+    {
+        burst(0, HALF_SAMPLES);
+        check_sums();
+    }
+
+    // the burst doesn't have to start at the first channel of the half, the channel is in the word
+    burst(3, HALF_SAMPLES);
+    check_sums();
+    burst(3, HALF_SAMPLES);
+    check_sums();
+}
+
+static void test_not_done(void)
+{
+    const volatile uint32_t *sums = hardware_pots_sums();
+    uint32_t previous[ADC_CHANNELS_COUNT];
+    uint8_t ch;
+
+    burst(0, HALF_SAMPLES);
+    burst(0, HALF_SAMPLES);
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+        previous[ch] = sums[ch];
+
+    // a conversion of channel 2 not done is skipped, the channel keeps its last sum until both halves
+    // hold its conversions again while the other channels go on
+    burst(0, 2);
+    dma_write(GDR_WORD(2, 0xFFF) & ~ADC_GDR_DONE_FLAG);
+    g_conversions[2]++;
+    burst(3, HALF_SAMPLES - 3);
+
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+    {
+        if (ch == 2) CHECK_EQUAL(sums[ch], previous[ch]);
+        else CHECK_EQUAL(sums[ch], expected_sum(ch) | HARDWARE_POT_SUM_VALID);
+    }
+
+    burst(0, HALF_SAMPLES);
+    CHECK_EQUAL(sums[2], previous[2]);
+
+    burst(0, HALF_SAMPLES);
+    check_sums();
+}
+
+static void test_other_channel(void)
+{
+    const volatile uint32_t *sums = hardware_pots_sums();
+    uint32_t previous[ADC_CHANNELS_COUNT];
+    uint8_t ch;
+
+    // half a transfer written, the interrupt of a serial channel leaves the sums alone
+    burst(0, HALF_SAMPLES / 2);
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+        previous[ch] = sums[ch];
+
+    g_serial_handler_calls = 0;
+    DMA_IRQHandler();
+
+    CHECK_EQUAL(g_serial_handler_calls, 1);
+    for (ch = 0; ch < ADC_CHANNELS_COUNT; ch++)
+        CHECK_EQUAL(sums[ch], previous[ch]);
+
+    burst(0, HALF_SAMPLES / 2);
+    check_sums();
+}
+
+int main(void)
+{
+    test_start();
+    test_halves();
+    test_not_done();
+    test_other_channel();
+
+    return test_result("pots dma");
+}
@@ -0,0 +1,237 @@
+/*
+ * protocol: dispatch of the messages to the commands through the index of their first token
+ */
+
+#include "mock.h"
+#include "protocol.h"
+#include "mod-protocol.h"
+
+#include <string.h>
+
+// commands registered on top of the ones below, enough to fill the index with collisions
+#define FILLER_COMMANDS     24
+
+static const char *g_commands[] = {
+    "pi",
+    "s %i %f",
+    "g %i",
+    "l %i %i %i %i ...",
+    "say %s ...",
+    "pipeline %i",
+    "rt %i %i ...",
+    "control_stats",
+    "pot_filter_set %i %i %i",
+    "pot_filter_get %i",
+    "a %i %s %i %s %f %f %f %i %i %i %i %i ...",
+};
+
+#define COMMANDS    (sizeof(g_commands) / sizeof(g_commands[0]))
+
+static char g_filler[FILLER_COMMANDS][16];
+
+// what the last callback got and what was sent back to the senders
+static int g_called, g_called_serial;
+static char g_called_token[32], g_called_last[32];
+static uint32_t g_called_count;
+static char g_sent[64];
+static int g_sent_serial;
+
+void ui_comm_webgui_send(const char *data, uint32_t data_size)
+{
+    snprintf(g_sent, sizeof(g_sent), "%.*s", (int) data_size, data);
+    g_sent_serial = WEBGUI_SERIAL;
+}
+
+void sys_comm_send(const char *command, const char *arguments)
+{
+    (void) arguments;
+    snprintf(g_sent, sizeof(g_sent), "%s", command);
+    g_sent_serial = SYSTEM_SERIAL;
+}
+
+static void command_cb(uint8_t serial_id, proto_t *proto)
+{
+    g_called++;
+    g_called_serial = serial_id;
+    snprintf(g_called_token, sizeof(g_called_token), "%s", proto->list[0]);
+    snprintf(g_called_last, sizeof(g_called_last), "%s", proto->list[proto->list_count - 1]);
+    g_called_count = proto->list_count;
+
+    // the tokens list is null terminated
+    CHECK(proto->list[proto->list_count] == NULL);
+
+    // the ping is answered, the others don't respond
+    if (strcmp(proto->list[0], "pi") == 0)
+        protocol_response("r 0", proto);
+}
+
+static void parse(int serial, const char *message)
+{
+    // room for a message with more tokens than the longest one the rx buffer holds
+    static char data[PROTOCOL_MAX_ARGUMENTS + 8];
+    msg_t msg;
+
+    snprintf(data, sizeof(data), "%s", message);
+    msg.sender_id = serial;
+    msg.data = data;
+    msg.data_size = strlen(data);
+
+    g_called = 0;
+    g_called_token[0] = 0;
+    g_sent[0] = 0;
+    g_sent_serial = -1;
+
+    protocol_parse(&msg);
+}
+
+static void test_dispatch(void)
+{
+    uint32_t i;
+    char message[32];
+
+    // every command is found by its first token, also the ones which collided in the index
+    for (i = 0; i < FILLER_COMMANDS; i++)
+    {
+        snprintf(message, sizeof(message), "f%u %u", i, i);
+        parse(WEBGUI_SERIAL, message);
+        CHECK_EQUAL(g_called, 1);
+        CHECK(strcmp(g_called_token, g_filler[i]) == 0);
+    }
+
+    parse(WEBGUI_SERIAL, "s 3 0.5");
+    CHECK_EQUAL(g_called, 1);
+    CHECK(strcmp(g_called_token, "s") == 0);
+    CHECK_EQUAL(g_called_count, 3);
+
+    parse(WEBGUI_SERIAL, "pot_filter_set 1 5 3");
+    CHECK_EQUAL(g_called, 1);
+    CHECK(strcmp(g_called_token, "pot_filter_set") == 0);
+
+    // the response goes back to the serial the message came from
+    parse(WEBGUI_SERIAL, "pi");
+    CHECK_EQUAL(g_called, 1);
+    CHECK(strcmp(g_sent, "r 0") == 0);
+    CHECK_EQUAL(g_sent_serial, WEBGUI_SERIAL);
+
+    parse(SYSTEM_SERIAL, "pi");
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_serial, SYSTEM_SERIAL);
+    CHECK(strcmp(g_sent, "r 0") == 0);
+    CHECK_EQUAL(g_sent_serial, SYSTEM_SERIAL);
+
+    // a command doesn't answer for another one with the same prefix
+    parse(WEBGUI_SERIAL, "p");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_COMMAND_NOT_FOUND) == 0);
+}
+
+static void test_arguments(void)
+{
+    static char message[PROTOCOL_MAX_ARGUMENTS + 8];
+    uint32_t i, size;
+
+    parse(WEBGUI_SERIAL, "unknown 1 2");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_COMMAND_NOT_FOUND) == 0);
+
+    parse(WEBGUI_SERIAL, "s 3");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_FEW_ARGUMENTS) == 0);
+
+    parse(WEBGUI_SERIAL, "s 3 0.5 1");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_MANY_ARGUMENTS) == 0);
+
+    // variable arguments take any amount after the fixed ones
+    parse(WEBGUI_SERIAL, "l 1 2 3 4 5 6 7");
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_count, 8);
+
+    parse(WEBGUI_SERIAL, "say hello");
+    CHECK_EQUAL(g_called, 1);
+
+    parse(WEBGUI_SERIAL, "l 1 2");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_FEW_ARGUMENTS) == 0);
+
+    // the longest message the static tokens list holds
+    size = snprintf(message, sizeof(message), "say");
+    for (i = 1; i < PROTOCOL_STATIC_ARGUMENTS; i++)
+        size += snprintf(&message[size], sizeof(message) - size, " %u", i % 10);
+
+    parse(WEBGUI_SERIAL, message);
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_count, PROTOCOL_STATIC_ARGUMENTS);
+
+    // a control_add with more scale points than the static list holds takes a list from the heap
+    size = snprintf(message, sizeof(message), "a 0 Gain 1 dB 0.0 -10.0 10.0 40 0 0 0 0");
+    for (i = 0; i < 40; i++)
+        size += snprintf(&message[size], sizeof(message) - size, " point%u %u.0", i, i);
+
+    parse(WEBGUI_SERIAL, message);
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_count, 13 + 2 * 40);
+    CHECK(strcmp(g_called_last, "39.0") == 0);
+
+    // the message with the most tokens the rx buffer holds, single chars and their separators
+    size = snprintf(message, sizeof(message), "say");
+    while (size + 2 < WEBGUI_COMM_RX_BUFF_SIZE)
+        size += snprintf(&message[size], sizeof(message) - size, " x");
+
+    parse(WEBGUI_SERIAL, message);
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_count, (size - 3) / 2 + 1);
+    CHECK(strcmp(g_called_last, "x") == 0);
+
+    // only empty tokens could go past the bound, they are refused
+    memset(message, ' ', PROTOCOL_MAX_ARGUMENTS);
+    memcpy(message, "say", 3);
+    message[PROTOCOL_MAX_ARGUMENTS] = 0;
+
+    parse(WEBGUI_SERIAL, message);
+    CHECK_EQUAL(g_called, 1);
+    CHECK_EQUAL(g_called_count, PROTOCOL_MAX_ARGUMENTS - 2);
+
+    memset(message, ' ', PROTOCOL_MAX_ARGUMENTS + 4);
+    memcpy(message, "say", 3);
+    message[PROTOCOL_MAX_ARGUMENTS + 4] = 0;
+
+    parse(WEBGUI_SERIAL, message);
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_MANY_ARGUMENTS) == 0);
+}
+
+static void test_remove(void)
+{
+    protocol_remove_commands();
+
+    parse(WEBGUI_SERIAL, "pi");
+    CHECK_EQUAL(g_called, 0);
+    CHECK(strcmp(g_sent, RESP_ERR_COMMAND_NOT_FOUND) == 0);
+
+    // the index is rebuilt from scratch
+    protocol_add_command("pi", command_cb);
+    parse(WEBGUI_SERIAL, "pi");
+    CHECK_EQUAL(g_called, 1);
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < COMMANDS; i++)
+        protocol_add_command(g_commands[i], command_cb);
+
+    for (i = 0; i < FILLER_COMMANDS; i++)
+    {
+        snprintf(g_filler[i], sizeof(g_filler[i]), "f%u %%i", i);
+        protocol_add_command(g_filler[i], command_cb);
+        g_filler[i][strcspn(g_filler[i], " ")] = 0;
+    }
+
+    test_dispatch();
+    test_arguments();
+    test_remove();
+
+    return test_result("protocol");
+}
@@ -0,0 +1,184 @@
+/*
+ * utils: ring buffer, checked against a plain FIFO model with random operations across the wrap
+ */
+
+#include "mock.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BUFFER_SIZE     64
+#define OPERATIONS      100000
+#define TOKEN           0
+
+// reference FIFO, holds the bytes in the order they were written
+static uint8_t g_model[BUFFER_SIZE];
+static uint32_t g_model_used;
+
+static uint8_t g_next_byte;
+
+static void model_write(const uint8_t *data, uint32_t size)
+{
+    memcpy(&g_model[g_model_used], data, size);
+    g_model_used += size;
+}
+
+static void model_read(uint8_t *buffer, uint32_t size)
+{
+    if (buffer) memcpy(buffer, g_model, size);
+    memmove(g_model, &g_model[size], g_model_used - size);
+    g_model_used -= size;
+}
+
+static uint32_t model_count(uint8_t byte)
+{
+    uint32_t i, count = 0;
+
+    for (i = 0; i < g_model_used; i++)
+        if (g_model[i] == byte) count++;
+
+    return count;
+}
+
+// bytes with a token now and then, as the protocol messages
+static void fill(uint8_t *data, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        g_next_byte++;
+        data[i] = (rand() % 8 == 0) ? TOKEN : (g_next_byte | 1);
+    }
+}
+
+static void test_create(void)
+{
+    ringbuff_t *rb;
+
+    rb = ringbuff_create(5);
+    CHECK_EQUAL(rb->size, 8);
+    ringbuff_destroy(rb);
+
+    rb = ringbuff_create(4096);
+    CHECK_EQUAL(rb->size, 4096);
+    ringbuff_destroy(rb);
+
+    // the serial buffers ask for one byte more than they hold
+    rb = ringbuff_create(4096 + 1);
+    CHECK_EQUAL(rb->size, 8192);
+    ringbuff_destroy(rb);
+}
+
+static void test_capacity(void)
+{
+    ringbuff_t *rb = ringbuff_create(BUFFER_SIZE);
+    uint8_t data[BUFFER_SIZE + 8], buffer[BUFFER_SIZE + 8];
+
+    fill(data, sizeof(data));
+
+    // one slot is kept free to tell full from empty
+    CHECK(ringbuff_is_empty(rb));
+    CHECK_EQUAL(ringbuff_write(rb, data, sizeof(data)), BUFFER_SIZE - 1);
+    CHECK(ringbuff_is_full(rb));
+    CHECK_EQUAL(ringbuffer_used_space(rb), BUFFER_SIZE - 1);
+    CHECK_EQUAL(ringbuff_write(rb, data, 1), 0);
+
+    CHECK_EQUAL(ringbuff_read(rb, buffer, sizeof(buffer)), BUFFER_SIZE - 1);
+    CHECK(memcmp(buffer, data, BUFFER_SIZE - 1) == 0);
+    CHECK(ringbuff_is_empty(rb));
+    CHECK_EQUAL(ringbuff_read(rb, buffer, 1), 0);
+
+    // a read until a token which isn't there leaves the data
+    ringbuff_write(rb, (const uint8_t *) "abc", 3);
+    CHECK_EQUAL(ringbuff_read_until(rb, buffer, sizeof(buffer), TOKEN), 0);
+    CHECK_EQUAL(ringbuffer_used_space(rb), 3);
+
+    ringbuff_destroy(rb);
+}
+
+static void test_random(void)
+{
+    ringbuff_t *rb = ringbuff_create(BUFFER_SIZE);
+    uint8_t data[BUFFER_SIZE], buffer[BUFFER_SIZE], *span;
+    uint32_t i, size, bytes, expected, contiguous;
+    uint8_t *found;
+
+    for (i = 0; i < OPERATIONS; i++)
+    {
+        size = rand() % BUFFER_SIZE;
+
+        switch (rand() % 6)
+        {
+            case 0:
+            case 1:
+                fill(data, size);
+                bytes = ringbuff_write(rb, data, size);
+                expected = size < (BUFFER_SIZE - 1 - g_model_used) ? size : (BUFFER_SIZE - 1 - g_model_used);
+                CHECK_EQUAL(bytes, expected);
+                model_write(data, bytes);
+                break;
+
+            case 2:
+                bytes = ringbuff_read(rb, buffer, size);
+                expected = size < g_model_used ? size : g_model_used;
+                CHECK_EQUAL(bytes, expected);
+                CHECK(memcmp(buffer, g_model, bytes) == 0);
+                model_read(NULL, bytes);
+                break;
+
+            case 3:
+                // the read until goes up to the token included, or reads nothing without one
+                found = memchr(g_model, TOKEN, g_model_used);
+                expected = found ? (uint32_t) (found - g_model) + 1 : 0;
+                if (expected > size) expected = size;
+
+                bytes = ringbuff_read_until(rb, buffer, size, TOKEN);
+                CHECK_EQUAL(bytes, expected);
+                CHECK(memcmp(buffer, g_model, bytes) == 0);
+                model_read(NULL, bytes);
+                break;
+
+            case 4:
+                // the span points to the oldest bytes, up to the end of the buffer
+                contiguous = ringbuff_peek_span(rb, &span);
+                CHECK_EQUAL(contiguous, g_model_used < (rb->size - rb->tail) ? g_model_used : (rb->size - rb->tail));
+                CHECK(memcmp(span, g_model, contiguous) == 0);
+
+                bytes = size < contiguous ? size : contiguous;
+                CHECK_EQUAL(ringbuff_read(rb, NULL, bytes), bytes);
+                model_read(NULL, bytes);
+                break;
+
+            case 5:
+                // as the DMA does, the bytes are written in place and published after
+                if (size > BUFFER_SIZE - 1 - g_model_used) size = BUFFER_SIZE - 1 - g_model_used;
+                fill(data, size);
+                for (bytes = 0; bytes < size; bytes++)
+                    rb->buffer[(rb->head + bytes) & (rb->size - 1)] = data[bytes];
+
+                ringbuff_publish(rb, rb->head + size);
+                model_write(data, size);
+                break;
+        }
+
+        CHECK_EQUAL(ringbuffer_used_space(rb), g_model_used);
+        CHECK_EQUAL(ringbuff_count(rb, TOKEN), model_count(TOKEN));
+
+        if (g_test_failures) break;
+    }
+
+    ringbuff_destroy(rb);
+}
+
+int main(void)
+{
+    srand(1);
+
+    test_create();
+    test_capacity();
+    test_random();
+
+    return test_result("ringbuff");
+}
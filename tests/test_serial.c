@@ -0,0 +1,515 @@
+/*
+ * serial: transmission of the tx ring buffer through the GPDMA, one transfer per contiguous span,
+ * and reception of frames through the GPDMA straight into the rx ring buffer
+ *
+ * the test plays the DMA: on transmission it takes the span programmed on the channel as sent and
+ * raises the terminal count interrupt, on reception it writes the bytes where the channel points and
+ * follows its linked list items, the uart interrupt then publishes them
+ */
+
+#include "mock.h"
+#include "serial.h"
+#include "device.h"
+
+#include <string.h>
+
+// the serials and GPDMA channels of the mod-ui and system links, the system link has a buffer
+// larger than a DMA transfer
+#define WEBGUI_UART         3
+#define WEBGUI_TX_CHANNEL   2
+#define SYSTEM_UART         0
+#define SYSTEM_TX_CHANNEL   3
+
+// a serial which only receives through the DMA, in frame mode
+#define RX_UART             1
+#define RX_CHANNEL          0
+#define RX_BUFFER_SIZE      256
+#define RX_MAX_FRAMES       8
+#define TOKEN               0
+
+#define OE_PORT             1
+#define OE_PIN              5
+
+#define DMA_MAX_TRANSFER    0xFFF
+
+static serial_t g_webgui = {
+    .uart_id = WEBGUI_UART, .baud_rate = 1500000, .priority = 1,
+    .rx_buffer_size = 256, .tx_buffer_size = 256,
+    .tx_dma_channel = WEBGUI_TX_CHANNEL, .rx_dma_channel = -1,
+    .has_oe = 1, .oe_port = OE_PORT, .oe_pin = OE_PIN,
+};
+
+static serial_t g_system = {
+    .uart_id = SYSTEM_UART, .baud_rate = 1500000, .priority = 2,
+    .rx_buffer_size = 256, .tx_buffer_size = 8192,
+    .tx_dma_channel = SYSTEM_TX_CHANNEL, .rx_dma_channel = -1,
+};
+
+static serial_t g_rx = {
+    .uart_id = RX_UART, .baud_rate = 1500000, .priority = 1,
+    .rx_buffer_size = RX_BUFFER_SIZE, .tx_buffer_size = 64,
+    .tx_dma_channel = -1, .rx_dma_channel = RX_CHANNEL,
+};
+
+// interrupt id returned by the uart
+static uint32_t g_uart_int_id = UART_IIR_INTID_THRE;
+
+// bytes left on the current rx DMA transfer
+static uint32_t g_rx_remaining;
+
+// what the DMA sent and how many transfers it took
+static uint8_t g_sent[16384];
+static uint32_t g_sent_size, g_transfers;
+static uint8_t g_next_byte;
+
+//// uart doubles
+
+void UART_Init(LPC_UART_TypeDef *UARTx, UART_CFG_Type *UART_ConfigStruct)
+{
+    (void) UARTx;
+    (void) UART_ConfigStruct;
+}
+
+void UART_ConfigStructInit(UART_CFG_Type *UART_InitStruct)
+{
+    memset(UART_InitStruct, 0, sizeof(UART_CFG_Type));
+}
+
+void UART_FIFOConfig(LPC_UART_TypeDef *UARTx, UART_FIFO_CFG_Type *FIFOCfg)
+{
+    (void) UARTx;
+    (void) FIFOCfg;
+}
+
+void UART_FIFOConfigStructInit(UART_FIFO_CFG_Type *UART_FIFOInitStruct)
+{
+    memset(UART_FIFOInitStruct, 0, sizeof(UART_FIFO_CFG_Type));
+}
+
+void UART_IntConfig(LPC_UART_TypeDef *UARTx, UART_INT_Type UARTIntCfg, FunctionalState NewState)
+{
+    (void) UARTx;
+    (void) UARTIntCfg;
+    (void) NewState;
+}
+
+void UART_TxCmd(LPC_UART_TypeDef *UARTx, FunctionalState NewState)
+{
+    (void) UARTx;
+    (void) NewState;
+}
+
+FlagStatus UART_CheckBusy(LPC_UART_TypeDef *UARTx)
+{
+    (void) UARTx;
+    return RESET;
+}
+
+uint32_t UART_GetIntId(LPC_UART_TypeDef *UARTx)
+{
+    (void) UARTx;
+    return g_uart_int_id;
+}
+
+uint8_t UART_GetLineStatus(LPC_UART_TypeDef *UARTx)
+{
+    (void) UARTx;
+    return 0;
+}
+
+uint32_t UART_Send(LPC_UART_TypeDef *UARTx, uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
+{
+    (void) UARTx;
+    (void) txbuf;
+    (void) flag;
+    return buflen;
+}
+
+uint32_t UART_Receive(LPC_UART_TypeDef *UARTx, uint8_t *rxbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
+{
+    (void) UARTx;
+    (void) rxbuf;
+    (void) buflen;
+    (void) flag;
+    return 0;
+}
+
+void serial_error(uint8_t uart_id, uint32_t error_bits)
+{
+    (void) uart_id;
+    (void) error_bits;
+}
+
+//// DMA engine
+
+// transfers the span programmed on the channel and raises its terminal count, returns its size
+static uint32_t dma_complete(uint8_t ch)
+{
+    LPC_GPDMACH_TypeDef *channel = (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (ch * 0x20));
+    uint32_t size;
+
+    if (!g_mock_dma_enabled[ch]) return 0;
+
+    size = channel->CControl & DMA_MAX_TRANSFER;
+
+    // the tx buffer is never sent in a loop, more than it holds means the spans aren't released
+    CHECK(g_sent_size + size <= sizeof(g_sent));
+    if (g_sent_size + size > sizeof(g_sent)) return 0;
+
+    memcpy(&g_sent[g_sent_size], MOCK_ADDRESS(channel->CSrcAddr), size);
+    g_sent_size += size;
+    g_transfers++;
+
+    g_mock_dma_enabled[ch] = 0;
+    g_mock_dma_status[ch] = 1;
+    serial_dma_handler();
+
+    return size;
+}
+
+static void dma_complete_all(uint8_t ch)
+{
+    while (dma_complete(ch));
+}
+
+static LPC_GPDMACH_TypeDef *rx_channel(void)
+{
+    return (LPC_GPDMACH_TypeDef *) (LPC_GPDMACH0_BASE + (RX_CHANNEL * 0x20));
+}
+
+// writes the bytes where the channel points, at the end of a transfer the next linked list item is loaded
+static void dma_receive(const uint8_t *data, uint32_t size)
+{
+    LPC_GPDMACH_TypeDef *channel = rx_channel();
+
+    while (size--)
+    {
+        if (g_rx_remaining == 0)
+        {
+            GPDMA_LLI_Type *lli = MOCK_ADDRESS(channel->CLLI);
+
+            CHECK(lli != NULL);
+            if (!lli) return;
+
+            channel->CDestAddr = lli->DstAddr;
+            channel->CLLI = lli->NextLLI;
+            channel->CControl = lli->Control;
+            g_rx_remaining = channel->CControl & DMA_MAX_TRANSFER;
+        }
+
+        *((uint8_t *) MOCK_ADDRESS(channel->CDestAddr)) = *data++;
+        channel->CDestAddr++;
+        g_rx_remaining--;
+    }
+}
+
+void UART1_IRQHandler(void);
+
+// the bytes are drained by the DMA and the uart fires the character time-out
+static void receive(const char *data, uint32_t size)
+{
+    dma_receive((const uint8_t *) data, size);
+
+    g_uart_int_id = UART_IIR_INTID_CTI;
+    UART1_IRQHandler();
+    g_uart_int_id = UART_IIR_INTID_THRE;
+}
+
+// reads the next frame, checks it and releases it, returns its size or zero if none
+static uint32_t read_frame(const char *expected, uint32_t expected_size)
+{
+    uint8_t *frame;
+    uint32_t size = serial_read_frame(RX_UART, &frame);
+
+    if (size == 0) return 0;
+
+    CHECK_EQUAL(size, expected_size);
+    CHECK(size == expected_size && memcmp(frame, expected, size) == 0);
+    serial_release_frame(RX_UART, size);
+
+    return size;
+}
+
+// same as read_frame, returns whether the frame was pointed in place on the ring buffer
+static uint8_t read_frame_in_place(const char *expected, uint32_t expected_size)
+{
+    uint8_t *frame;
+    uint8_t *buffer = g_rx.rx_buffer->buffer;
+    uint32_t size = serial_read_frame(RX_UART, &frame);
+
+    CHECK_EQUAL(size, expected_size);
+    CHECK(size == expected_size && memcmp(frame, expected, size) == 0);
+    serial_release_frame(RX_UART, size);
+
+    return size > 0 && frame >= buffer && frame < &buffer[g_rx.rx_buffer->size];
+}
+
+static void sent_reset(void)
+{
+    g_sent_size = 0;
+    g_transfers = 0;
+}
+
+static void fill(uint8_t *data, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < size; i++)
+        data[i] = g_next_byte++;
+}
+
+static uint8_t oe_active(void)
+{
+    return (g_mock_pins[OE_PORT] >> OE_PIN) & 1;
+}
+
+static void test_span(void)
+{
+    uint8_t data[200];
+
+    // a message is sent with a single transfer and the output is enabled only meanwhile
+    fill(data, 100);
+    sent_reset();
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, data, 100), 100);
+    CHECK(g_mock_dma_enabled[WEBGUI_TX_CHANNEL]);
+    CHECK(oe_active());
+
+    dma_complete_all(WEBGUI_TX_CHANNEL);
+    CHECK_EQUAL(g_transfers, 1);
+    CHECK_EQUAL(g_sent_size, 100);
+    CHECK(memcmp(g_sent, data, 100) == 0);
+    CHECK(!oe_active());
+    CHECK(ringbuff_is_empty(g_webgui.tx_buffer));
+
+    // a message which wraps the ring buffer takes a transfer for each side of the wrap
+    fill(data, 200);
+    sent_reset();
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, data, 200), 200);
+    dma_complete_all(WEBGUI_TX_CHANNEL);
+    CHECK_EQUAL(g_transfers, 2);
+    CHECK_EQUAL(g_sent_size, 200);
+    CHECK(memcmp(g_sent, data, 200) == 0);
+    CHECK(!oe_active());
+}
+
+static void test_queued(void)
+{
+    uint8_t data[300];
+
+    // the bytes queued during a transfer go on the next one, in order
+    fill(data, sizeof(data));
+    sent_reset();
+    serial_try_send(WEBGUI_UART, data, 50);
+    serial_try_send(WEBGUI_UART, &data[50], 30);
+    CHECK_EQUAL(dma_complete(WEBGUI_TX_CHANNEL), 50);
+    CHECK(oe_active());
+
+    serial_try_send(WEBGUI_UART, &data[80], 20);
+    dma_complete_all(WEBGUI_TX_CHANNEL);
+    CHECK_EQUAL(g_sent_size, 100);
+    CHECK(memcmp(g_sent, data, 100) == 0);
+    CHECK(!oe_active());
+
+    // the bytes are only freed once transferred, so a full buffer takes no more until the transfer ends
+    sent_reset();
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, data, sizeof(data)), 255);
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, data, sizeof(data)), 0);
+    dma_complete(WEBGUI_TX_CHANNEL);
+    CHECK(serial_try_send(WEBGUI_UART, &data[255], sizeof(data) - 255) > 0);
+    dma_complete_all(WEBGUI_TX_CHANNEL);
+    CHECK_EQUAL(g_sent_size, sizeof(data));
+    CHECK(memcmp(g_sent, data, sizeof(data)) == 0);
+}
+
+static void test_max_transfer(void)
+{
+    static uint8_t data[6000];
+
+    // a span longer than a DMA transfer is split, the other serial is left alone
+    fill(data, sizeof(data));
+    sent_reset();
+    CHECK_EQUAL(serial_try_send(SYSTEM_UART, data, sizeof(data)), sizeof(data));
+    CHECK(!g_mock_dma_enabled[WEBGUI_TX_CHANNEL]);
+
+    CHECK_EQUAL(dma_complete(SYSTEM_TX_CHANNEL), DMA_MAX_TRANSFER);
+    dma_complete_all(SYSTEM_TX_CHANNEL);
+    CHECK_EQUAL(g_transfers, 2);
+    CHECK_EQUAL(g_sent_size, sizeof(data));
+    CHECK(memcmp(g_sent, data, sizeof(data)) == 0);
+}
+
+static void test_flush(void)
+{
+    uint8_t data[140];
+
+    // a flush during a transfer drops it, the bytes sent after the flush are all transmitted
+    fill(data, sizeof(data));
+    sent_reset();
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, data, 100), 100);
+    CHECK(g_mock_dma_enabled[WEBGUI_TX_CHANNEL]);
+
+    serial_flush_tx_buffer(WEBGUI_UART);
+    CHECK(!g_mock_dma_enabled[WEBGUI_TX_CHANNEL]);
+    CHECK(!oe_active());
+
+    CHECK_EQUAL(serial_try_send(WEBGUI_UART, &data[100], 40), 40);
+    dma_complete_all(WEBGUI_TX_CHANNEL);
+    CHECK_EQUAL(g_sent_size, 40);
+    CHECK(memcmp(g_sent, &data[100], 40) == 0);
+    CHECK(ringbuff_is_empty(g_webgui.tx_buffer));
+    CHECK(!oe_active());
+}
+
+static void test_frames(void)
+{
+    char data[RX_BUFFER_SIZE];
+    uint32_t i, blocked;
+
+    // the first transfer is the one programmed by the setup
+    g_rx_remaining = rx_channel()->CControl & DMA_MAX_TRANSFER;
+    CHECK_EQUAL(g_rx_remaining, RX_BUFFER_SIZE / 2);
+
+    receive("hello", 6);
+    CHECK_EQUAL(read_frame("hello", 6), 6);
+
+    // no frame is left, the task would block
+    blocked = g_mock_blocked;
+    CHECK_EQUAL(read_frame("", 0), 0);
+    CHECK_EQUAL(g_mock_blocked, blocked + 1);
+
+    // several frames in a burst and one split across two bursts
+    receive("one\0two\0thr", 11);
+    receive("ee\0", 3);
+    CHECK_EQUAL(read_frame("one", 4), 4);
+    CHECK_EQUAL(read_frame("two", 4), 4);
+    CHECK_EQUAL(read_frame("three", 6), 6);
+    CHECK(ringbuff_is_empty(g_rx.rx_buffer));
+
+    // the DMA could write over a frame being parsed, so it is copied even when it doesn't wrap
+    receive("x", 2);
+    CHECK(!read_frame_in_place("x", 2));
+    CHECK(ringbuff_is_empty(g_rx.rx_buffer));
+
+    // the DMA goes on through both halves and a frame across the end of the ring buffer is copied
+    for (i = 0; i < 99; i++) data[i] = 'a' + (i % 26);
+    data[99] = 0;
+    receive(data, 100);
+    receive(data, 100);
+    CHECK_EQUAL(read_frame(data, 100), 100);
+    CHECK_EQUAL(read_frame(data, 100), 100);
+
+    receive(data, 100);
+    CHECK(g_rx.rx_buffer->tail + 100 > RX_BUFFER_SIZE);
+    CHECK(!read_frame_in_place(data, 100));
+    CHECK(ringbuff_is_empty(g_rx.rx_buffer));
+}
+
+static void test_overrun(void)
+{
+    char data[RX_BUFFER_SIZE];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(data); i++) data[i] = 'a' + (i % 26);
+
+    // the frame is received but not released, the DMA writes over it meanwhile
+    data[99] = 0;
+    receive(data, 100);
+    data[99] = 'z';
+    dma_receive((uint8_t *) data, 120);
+    receive(data, 80);
+
+    // the frame read before is stale and the partial frame after the overrun is dropped
+    CHECK_EQUAL(read_frame("", 0), 0);
+    CHECK(ringbuff_is_empty(g_rx.rx_buffer));
+    receive("tail", 5);
+    CHECK_EQUAL(read_frame("", 0), 0);
+
+    // the frames are back in sync from the next token on
+    receive("next", 5);
+    CHECK_EQUAL(read_frame("next", 5), 5);
+    CHECK_EQUAL(read_frame("", 0), 0);
+}
+
+static void test_overrun_parsed(void)
+{
+    char data[RX_BUFFER_SIZE];
+    uint8_t *frame;
+    uint32_t i, size;
+
+    for (i = 0; i < sizeof(data); i++) data[i] = 'a' + (i % 26);
+
+    // the frame was copied and released when it was read, the DMA has the whole ring buffer while
+    // it is parsed, even a full ring of bytes received meanwhile doesn't reach it
+    receive("parsed", 7);
+    size = serial_read_frame(RX_UART, &frame);
+    CHECK_EQUAL(size, 7);
+    dma_receive((uint8_t *) data, RX_BUFFER_SIZE - 1);
+    CHECK(memcmp(frame, "parsed", 7) == 0);
+    serial_release_frame(RX_UART, size);
+
+    g_uart_int_id = UART_IIR_INTID_CTI;
+    UART1_IRQHandler();
+    g_uart_int_id = UART_IIR_INTID_THRE;
+    CHECK_EQUAL(read_frame("", 0), 0);
+    CHECK_EQUAL(ringbuffer_used_space(g_rx.rx_buffer), RX_BUFFER_SIZE - 1);
+    serial_flush_frames(RX_UART);
+
+    // the DMA went over the frame before the uart interrupt saw the overrun, the copy is dropped
+    receive("late", 5);
+    dma_receive((uint8_t *) data, RX_BUFFER_SIZE - 2);
+    CHECK_EQUAL(read_frame("", 0), 0);
+
+    // the interrupt drops the rest and the frames are back in sync from the next token on
+    g_uart_int_id = UART_IIR_INTID_CTI;
+    UART1_IRQHandler();
+    g_uart_int_id = UART_IIR_INTID_THRE;
+    CHECK(ringbuff_is_empty(g_rx.rx_buffer));
+    receive("tail", 5);
+    CHECK_EQUAL(read_frame("", 0), 0);
+    receive("next", 5);
+    CHECK_EQUAL(read_frame("next", 5), 5);
+}
+
+static void test_poll(void)
+{
+    uint32_t pending = 1UL << UART1_IRQn;
+
+    // without new bytes the poll leaves the uart interrupt alone
+    NVIC_ClearPendingIRQ(UART1_IRQn);
+    serial_rx_dma_poll();
+    CHECK(!(NVIC->ISPR[0] & pending));
+
+    // the DMA drained the last bytes without the uart interrupt, the poll pends it to publish them
+    dma_receive((const uint8_t *) "late", 5);
+    serial_rx_dma_poll();
+    CHECK(NVIC->ISPR[0] & pending);
+
+    g_uart_int_id = UART_IIR_INTID_RDA;
+    UART1_IRQHandler();
+    g_uart_int_id = UART_IIR_INTID_THRE;
+    CHECK_EQUAL(read_frame("late", 5), 5);
+}
+
+int main(void)
+{
+    serial_init(&g_webgui);
+    serial_enable_interupt(&g_webgui);
+    serial_init(&g_system);
+    serial_enable_interupt(&g_system);
+
+    serial_init(&g_rx);
+    serial_enable_interupt(&g_rx);
+    serial_set_frames(RX_UART, TOKEN, RX_MAX_FRAMES);
+
+    test_span();
+    test_queued();
+    test_max_transfer();
+    test_flush();
+
+    test_frames();
+    test_overrun();
+    test_overrun_parsed();
+    test_poll();
+
+    return test_result("serial");
+}
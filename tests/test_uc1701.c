@@ -0,0 +1,373 @@
+/*
+ * uc1701: the update only sends the changed columns of each page which were presented, and the rect
+ * fill and the image drawing by pages match the same drawings done pixel by pixel
+ *
+ * the SSP doubles play the display controller: they decode the page and column commands and keep
+ * the data written in a model of its RAM, which must match the buffer after each update
+ */
+
+#include "mock.h"
+#include "uc1701.h"
+#include "hw_uc1701.h"
+#include "device.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGES       (DISPLAY_HEIGHT / 8)
+
+#define RANDOM_DRAWINGS     20000
+
+// the pins of the display, all on the same port
+#define PORT        2
+#define CS_PIN      0
+#define CD_PIN      1
+
+// the columns of the display are the last ones of the chip when they are reversed
+#ifdef UC1701_REVERSE_COLUMNS
+#define COLUMNS_OFFSET  (CHIP_COLUMNS - DISPLAY_WIDTH)
+#else
+#define COLUMNS_OFFSET  0
+#endif
+
+static uc1701_t g_disp = {
+    .cs_port = PORT, .cs_pin = CS_PIN,
+    .cd_port = PORT, .cd_pin = CD_PIN,
+    .rst_port = PORT, .rst_pin = 2,
+    .backlight_port = PORT, .backlight_pin = 3,
+};
+
+// RAM of the display controller and its address
+static uint8_t g_ram[PAGES][CHIP_COLUMNS];
+static uint8_t g_page, g_column;
+// the next command byte is the argument of the previous command
+static uint8_t g_command_argument;
+
+// data bytes sent and update requests since the last reset
+static uint32_t g_data_bytes, g_requests;
+
+//// SSP doubles
+
+void SSP_ConfigStructInit(SSP_CFG_Type *SSP_InitStruct)
+{
+    memset(SSP_InitStruct, 0, sizeof(SSP_CFG_Type));
+}
+
+void SSP_Init(LPC_SSP_TypeDef *SSPx, SSP_CFG_Type *SSP_ConfigStruct)
+{
+    (void) SSPx;
+    (void) SSP_ConfigStruct;
+}
+
+void SSP_Cmd(LPC_SSP_TypeDef *SSPx, FunctionalState NewState)
+{
+    (void) SSPx;
+    (void) NewState;
+}
+
+// the FIFO is always empty and never busy
+FlagStatus SSP_GetStatus(LPC_SSP_TypeDef *SSPx, uint32_t FlagType)
+{
+    (void) SSPx;
+    return (FlagType == SSP_STAT_BUSY) ? RESET : SET;
+}
+
+void SSP_SendData(LPC_SSP_TypeDef *SSPx, uint16_t Data)
+{
+    uint32_t pins = g_mock_pins[PORT];
+
+    (void) SSPx;
+
+    CHECK(!(pins & (1 << CS_PIN)));
+
+    // data mode
+    if (pins & (1 << CD_PIN))
+    {
+        CHECK(g_page < PAGES && g_column < CHIP_COLUMNS);
+        if (g_page < PAGES && g_column < CHIP_COLUMNS)
+            g_ram[g_page][g_column++] = Data;
+
+        g_data_bytes++;
+        return;
+    }
+
+    if (g_command_argument)
+        g_command_argument = 0;
+    else if (Data == UC1701_SET_PM)
+        g_command_argument = 1;
+    else if ((Data & 0xF0) == UC1701_SET_PA)
+        g_page = Data & UC1701_SET_PA_MASK;
+    else if ((Data & 0xF0) == UC1701_SET_CA_MSB)
+        g_column = (g_column & 0x0F) | ((Data & UC1701_SET_CA_MASK) << 4);
+    else if ((Data & 0xF0) == UC1701_SET_CA_LSB)
+        g_column = (g_column & 0xF0) | (Data & UC1701_SET_CA_MASK);
+}
+
+void uc1701_update_request(uc1701_t *disp)
+{
+    (void) disp;
+    g_requests++;
+}
+
+static void counters_reset(void)
+{
+    g_data_bytes = 0;
+    g_requests = 0;
+}
+
+// presents and updates the display and returns the data bytes sent, the display must show the buffer after it
+static uint32_t update(void)
+{
+    uint8_t page;
+
+    g_data_bytes = 0;
+    uc1701_present(&g_disp);
+    uc1701_update(&g_disp);
+
+    for (page = 0; page < PAGES; page++)
+        CHECK(memcmp(&g_ram[page][COLUMNS_OFFSET], g_disp.buffer[page], DISPLAY_WIDTH) == 0);
+
+    return g_data_bytes;
+}
+
+//// pixel by pixel reference, the buffer columns are stored from right to left
+
+static void ref_set_pixel(uint8_t buffer[PAGES][DISPLAY_WIDTH], uint8_t x, uint8_t y, uint8_t color)
+{
+    uint8_t *data = &buffer[y / 8][(DISPLAY_WIDTH - 1) - x];
+
+    *data = (*data & ~(1 << (y % 8))) | ((color & 0x01) << (y % 8));
+}
+
+// the rect is drawn column by column, the stripes alternate every row starting with black at the top
+// and the chess alternates the stripes every column
+static void ref_rect_fill(uint8_t buffer[PAGES][DISPLAY_WIDTH], uint8_t x, uint8_t y,
+                          uint8_t width, uint8_t height, uint8_t color)
+{
+    uint8_t i, j, stripes, pixel;
+
+    for (i = 0; i < width && (x + i) < DISPLAY_WIDTH; i++)
+    {
+        stripes = color;
+        if (color == UC1701_CHESS) stripes = (i % 2) ? UC1701_WHITE_BLACK : UC1701_BLACK_WHITE;
+
+        for (j = 0; j < height && (y + j) < DISPLAY_HEIGHT; j++)
+        {
+            if (stripes == UC1701_BLACK_WHITE) pixel = (j % 2) ? UC1701_WHITE : UC1701_BLACK;
+            else if (stripes == UC1701_WHITE_BLACK) pixel = (j % 2) ? UC1701_BLACK : UC1701_WHITE;
+            else pixel = stripes;
+
+            ref_set_pixel(buffer, x + i, y + j, pixel);
+        }
+    }
+}
+
+static void ref_draw_image(uint8_t buffer[PAGES][DISPLAY_WIDTH], uint8_t x, uint8_t y,
+                           const uint8_t *image, uint8_t color)
+{
+    uint8_t width = image[0], height = image[1];
+    uint8_t i, row, data;
+
+    for (row = 0; row < height; row++)
+    {
+        for (i = 0; i < width; i++)
+        {
+            if ((x + i) >= DISPLAY_WIDTH || (y + row) >= DISPLAY_HEIGHT) continue;
+
+            data = image[2 + (row / 8) * width + i];
+            if (color == UC1701_WHITE) data = ~data;
+
+            ref_set_pixel(buffer, x + i, y + row, (data >> (row % 8)) & 1);
+        }
+    }
+}
+
+// random contents on the buffer and on the display, as if it had been updated
+static void randomize(uint8_t reference[PAGES][DISPLAY_WIDTH])
+{
+    uint8_t page, i;
+
+    for (page = 0; page < PAGES; page++)
+        for (i = 0; i < DISPLAY_WIDTH; i++)
+            g_disp.buffer[page][i] = rand();
+
+    memcpy(reference, g_disp.buffer, sizeof(g_disp.buffer));
+    for (page = 0; page < PAGES; page++)
+    {
+        memcpy(g_disp.frame[page], g_disp.buffer[page], DISPLAY_WIDTH);
+        memcpy(&g_ram[page][COLUMNS_OFFSET], g_disp.buffer[page], DISPLAY_WIDTH);
+    }
+}
+
+static void test_full(void)
+{
+    // the init clears the whole display
+    CHECK_EQUAL(g_data_bytes, DISPLAY_WIDTH * PAGES);
+
+    counters_reset();
+    CHECK_EQUAL(update(), 0);
+
+    uc1701_clear(&g_disp, UC1701_BLACK);
+    CHECK_EQUAL(g_requests, 1);
+    CHECK_EQUAL(update(), DISPLAY_WIDTH * PAGES);
+
+    uc1701_clear(&g_disp, UC1701_WHITE);
+    CHECK_EQUAL(update(), DISPLAY_WIDTH * PAGES);
+}
+
+static void test_spans(void)
+{
+    static const uint8_t image[] = {3, 8, 0x81, 0x42, 0x24};
+
+    counters_reset();
+
+    // a pixel is a single byte
+    uc1701_set_pixel(&g_disp, 10, 10, UC1701_BLACK);
+    CHECK_EQUAL(update(), 1);
+
+    // lines take their columns on each page they cross
+    uc1701_hline(&g_disp, 20, 30, 16, UC1701_BLACK);
+    CHECK_EQUAL(update(), 16);
+
+    uc1701_vline(&g_disp, 50, 4, 20, UC1701_BLACK);
+    CHECK_EQUAL(update(), 3);
+
+    // a rect across two pages
+    uc1701_rect_fill(&g_disp, 60, 20, 20, 10, UC1701_BLACK);
+    CHECK_EQUAL(update(), 2 * 20);
+
+    uc1701_rect_invert(&g_disp, 60, 20, 20, 10);
+    CHECK_EQUAL(update(), 2 * 20);
+
+    // an image not aligned to a page crosses into the next one
+    uc1701_draw_image(&g_disp, 100, 36, image, UC1701_BLACK);
+    CHECK_EQUAL(update(), 2 * 3);
+
+    // the changes of the same page are sent as one span from the first to the last changed column
+    uc1701_set_pixel(&g_disp, 5, 60, UC1701_BLACK);
+    uc1701_set_pixel(&g_disp, 14, 60, UC1701_BLACK);
+    CHECK_EQUAL(update(), 10);
+
+    // only the first change of an up to date display requests the update
+    CHECK_EQUAL(g_requests, 7);
+}
+
+static void test_screens(void)
+{
+    // a pot value redrawn: its box cleared and the new value written on a page
+    uc1701_rect_fill(&g_disp, 90, 48, 30, 8, UC1701_WHITE);
+    uc1701_text(&g_disp, 90, 48, "100%", NULL, UC1701_BLACK);
+    CHECK_EQUAL(update(), 30);
+
+    // a label is sent as its characters and the spaces between them
+    uc1701_text(&g_disp, 0, 0, "Gain", NULL, UC1701_BLACK);
+    CHECK_EQUAL(update(), 4 * 5 + 3);
+
+    // a text not aligned to a page changes two pages
+    uc1701_text(&g_disp, 0, 20, "Gain", NULL, UC1701_BLACK);
+    CHECK_EQUAL(update(), 2 * (4 * 5 + 3));
+}
+
+static void test_present(void)
+{
+    uint8_t page;
+
+    // a screen drawn by several calls is not sent until it is presented
+    uc1701_rect_fill(&g_disp, 0, 0, 40, 16, UC1701_BLACK);
+    g_data_bytes = 0;
+    uc1701_update(&g_disp);
+    CHECK_EQUAL(g_data_bytes, 0);
+    for (page = 0; page < 2; page++)
+        CHECK(memcmp(&g_ram[page][COLUMNS_OFFSET], g_disp.buffer[page], DISPLAY_WIDTH) != 0);
+
+    uc1701_text(&g_disp, 0, 20, "Gain", NULL, UC1701_BLACK);
+    CHECK_EQUAL(update(), 2 * 40 + 2 * (4 * 5 + 3));
+
+    // the drawings made after the present wait for the next one, the frame sent is the presented one
+    uc1701_rect_fill(&g_disp, 60, 0, 10, 8, UC1701_BLACK);
+    uc1701_present(&g_disp);
+    uc1701_rect_fill(&g_disp, 60, 8, 10, 8, UC1701_BLACK);
+    g_data_bytes = 0;
+    uc1701_update(&g_disp);
+    CHECK_EQUAL(g_data_bytes, 10);
+    CHECK(memcmp(&g_ram[1][COLUMNS_OFFSET], g_disp.buffer[1], DISPLAY_WIDTH) != 0);
+    CHECK_EQUAL(update(), 10);
+
+    // the spans presented twice before an update are sent once
+    uc1701_set_pixel(&g_disp, 5, 60, UC1701_BLACK);
+    uc1701_present(&g_disp);
+    uc1701_set_pixel(&g_disp, 14, 60, UC1701_BLACK);
+    CHECK_EQUAL(update(), 10);
+}
+
+static void test_rect_fill(void)
+{
+    static uint8_t reference[PAGES][DISPLAY_WIDTH];
+    uint8_t x, y, width, height, color;
+    uint32_t i;
+
+    // the update checks that the dirty spans cover every change as well
+    for (i = 0; i < RANDOM_DRAWINGS && !g_test_failures; i++)
+    {
+        randomize(reference);
+
+        x = rand() % DISPLAY_WIDTH;
+        y = rand() % DISPLAY_HEIGHT;
+        width = 1 + rand() % DISPLAY_WIDTH;
+        height = 1 + rand() % DISPLAY_HEIGHT;
+        color = rand() % 5;
+
+        uc1701_rect_fill(&g_disp, x, y, width, height, color);
+        ref_rect_fill(reference, x, y, width, height, color);
+
+        CHECK(memcmp(g_disp.buffer, reference, sizeof(reference)) == 0);
+        update();
+    }
+}
+
+static void test_draw_image(void)
+{
+    static uint8_t reference[PAGES][DISPLAY_WIDTH];
+    uint8_t image[2 + DISPLAY_WIDTH * PAGES];
+    uint8_t x, y, width, height, color;
+    uint32_t i, j;
+
+    for (i = 0; i < RANDOM_DRAWINGS && !g_test_failures; i++)
+    {
+        randomize(reference);
+
+        width = 1 + rand() % DISPLAY_WIDTH;
+        height = 8 * (1 + rand() % PAGES);
+        image[0] = width;
+        image[1] = height;
+        for (j = 0; j < (uint32_t) width * (height / 8); j++)
+            image[2 + j] = rand();
+
+        // the image may go past the right and bottom borders
+        x = rand() % DISPLAY_WIDTH;
+        y = rand() % DISPLAY_HEIGHT;
+        color = rand() % 2;
+
+        uc1701_draw_image(&g_disp, x, y, image, color);
+        ref_draw_image(reference, x, y, image, color);
+
+        CHECK(memcmp(g_disp.buffer, reference, sizeof(reference)) == 0);
+        update();
+    }
+}
+
+int main(void)
+{
+    srand(1);
+
+    uc1701_init(&g_disp);
+
+    test_full();
+    test_spans();
+    test_screens();
+    test_present();
+    test_rect_fill();
+    test_draw_image();
+
+    return test_result("uc1701");
+}